@@ -1,139 +1,1099 @@
 #include<iostream>
 #include<string>
+#include<string_view>
+#include<cstring>
+#include<cassert>
+#include<array>
+#include<bit>
+#include<memory>
+#include<memory_resource>
+#include<unordered_map>
+#include<chrono>
+#include<random>
+#include<vector>
+#include<cmath>
+#include<charconv>
+#include<sstream>
+#include<cstdio>
+#include<algorithm>
+#include<cstdint>
+#include<limits>
+#include<atomic>
+#include<mutex>
+#include<shared_mutex>
+#include<thread>
+#include<stdexcept>
+#ifdef __linux__
+#include<sys/uio.h>
+#include<fcntl.h>
+#include<unistd.h>
+#include<climits>
+#endif
+#if defined(__x86_64__)
+#include<immintrin.h>
+#endif
 
-class String {
-    static size_t constexpr SSO_SIZE = 16;  
-    size_t m_size{};
-    size_t m_cap{SSO_SIZE-1};
-    alignas(alignof(char*)) char m_data[SSO_SIZE]{};
-    bool isSmall() const {
-        return m_cap < SSO_SIZE;
+/*
+Search / hash kernels on raw (ptr, len), shared by every BasicString instantiation
+    - findChar / findSubstr have scalar, SSE2 and AVX2 versions, picked once at first use via CPUID
+      (__builtin_cpu_supports), SSE2 is part of x86-64 so only AVX2 needs a check
+    - findSubstr filters candidates by comparing needle's first and last char against two shifted
+      blocks at once, only positions matching both are verified with memcmp
+    - compare / starts_with stay on memcmp, glibc already dispatches it to vector code
+    - hashBytes : 64 bit multiply-mix hash reading 16 bytes per step, keys up to 16 bytes take two
+      overlapping loads and no loop, not stable across versions
+*/
+static constexpr size_t NPOS = static_cast<size_t>(-1);
+
+inline uint64_t readU64(const char* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+// Folds 128 bit product of a and b into 64 bits
+inline uint64_t mix64(uint64_t a, uint64_t b) {
+    __uint128_t r = static_cast<__uint128_t>(a) * b;
+    return static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64);
+}
+inline uint64_t readU32(const char* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+inline uint64_t hashBytes(const char* p, size_t n, uint64_t seed = 0) {
+    constexpr uint64_t K0 = 0xa0761d6478bd642full;
+    constexpr uint64_t K1 = 0xe7037ed1a0b428dbull;
+    uint64_t h = seed ^ K0 ^ n;
+    uint64_t a = 0, b = 0;
+    if (n <= 16) {
+        // Short keys : two possibly overlapping reads, no loop and no copy
+        if (n >= 8) {
+            a = readU64(p);
+            b = readU64(p + n - 8);
+        }
+        else if (n >= 4) {
+            a = readU32(p);
+            b = readU32(p + n - 4);
+        }
+        else if (n > 0) {
+            a = (uint64_t(uint8_t(p[0])) << 16) | (uint64_t(uint8_t(p[n >> 1])) << 8) | uint8_t(p[n - 1]);
+        }
+    }
+    else {
+        size_t i = 0;
+        for (; i + 16 < n; i += 16) {
+            h = mix64(readU64(p + i) ^ K1, readU64(p + i + 8) ^ h);
+        }
+        // Last 16 bytes, overlapping the previous block if n is not a multiple of 16
+        a = readU64(p + n - 16);
+        b = readU64(p + n - 8);
+    }
+    return mix64(K1 ^ n, mix64(a ^ K1, b ^ h));
+}
+
+inline size_t findCharScalar(const char* p, size_t n, char c) {
+    for (size_t i = 0; i < n; i++) {
+        if (p[i] == c) return i;
     }
-    char* getHeapPtr() { 
-        return *(reinterpret_cast<char**>(m_data));
+    return NPOS;
+}
+inline size_t findSubstrScalar(const char* p, size_t n, const char* needle, size_t m) {
+    for (size_t i = 0; i + m <= n; i++) {
+        if (p[i] == needle[0] && std::memcmp(p + i, needle, m) == 0) return i;
     }
-    const char* getHeapPtr() const { 
-        return *(reinterpret_cast<const char* const *>(m_data));
+    return NPOS;
+}
+
+#if defined(__x86_64__)
+inline size_t findCharSse2(const char* p, size_t n, char c) {
+    __m128i v = _mm_set1_epi8(c);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)), v));
+        if (mask != 0) return i + static_cast<size_t>(std::countr_zero(static_cast<unsigned>(mask)));
+    }
+    size_t r = findCharScalar(p + i, n - i, c);
+    return (r == NPOS ? NPOS : i + r);
+}
+__attribute__((target("avx2"))) inline size_t findCharAvx2(const char* p, size_t n, char c) {
+    __m256i v = _mm256_set1_epi8(c);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        int mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)), v));
+        if (mask != 0) return i + static_cast<size_t>(std::countr_zero(static_cast<unsigned>(mask)));
+    }
+    size_t r = findCharSse2(p + i, n - i, c);
+    return (r == NPOS ? NPOS : i + r);
+}
+// Caller guarantees 2 <= m <= n
+inline size_t findSubstrSse2(const char* p, size_t n, const char* needle, size_t m) {
+    __m128i first = _mm_set1_epi8(needle[0]);
+    __m128i last = _mm_set1_epi8(needle[m - 1]);
+    size_t i = 0;
+    for (; i + m - 1 + 16 <= n; i += 16) {
+        __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + m - 1));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last))));
+        while (mask != 0) {
+            size_t pos = i + static_cast<size_t>(std::countr_zero(mask));
+            if (std::memcmp(p + pos + 1, needle + 1, m - 2) == 0) return pos;
+            mask &= mask - 1;
+        }
+    }
+    size_t r = findSubstrScalar(p + i, n - i, needle, m);
+    return (r == NPOS ? NPOS : i + r);
+}
+__attribute__((target("avx2"))) inline size_t findSubstrAvx2(const char* p, size_t n, const char* needle, size_t m) {
+    __m256i first = _mm256_set1_epi8(needle[0]);
+    __m256i last = _mm256_set1_epi8(needle[m - 1]);
+    size_t i = 0;
+    for (; i + m - 1 + 32 <= n; i += 32) {
+        __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        __m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i + m - 1));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first), _mm256_cmpeq_epi8(blockLast, last))));
+        while (mask != 0) {
+            size_t pos = i + static_cast<size_t>(std::countr_zero(mask));
+            if (std::memcmp(p + pos + 1, needle + 1, m - 2) == 0) return pos;
+            mask &= mask - 1;
+        }
+    }
+    size_t r = findSubstrSse2(p + i, n - i, needle, m);
+    return (r == NPOS ? NPOS : i + r);
+}
+#endif
+
+struct StringKernels {
+    size_t (*findChar)(const char*, size_t, char);
+    size_t (*findSubstr)(const char*, size_t, const char*, size_t);
+};
+inline const StringKernels& stringKernels() {
+    static const StringKernels kernels = []() {
+#if defined(__x86_64__)
+        if (__builtin_cpu_supports("avx2")) {
+            return StringKernels{findCharAvx2, findSubstrAvx2};
+        }
+        return StringKernels{findCharSse2, findSubstrSse2};
+#else
+        return StringKernels{findCharScalar, findSubstrScalar};
+#endif
+    }();
+    return kernels;
+}
+
+/*
+AllocT : heap buffers are allocated from AllocT, std::allocator keeps plain new[] / delete[]
+Allocator propagation on copy / move / swap follows the allocator's traits, same as std containers
+
+Layout (libc++ style, 24 bytes) :
+    - Long  : { char* ptr, size_t size, size_t cap | LONG_FLAG }
+    - Short : { char data[23], unsigned char remaining } where remaining = 23 - size
+    - Last byte is the top byte of cap in long mode, so its high bit tells the modes apart
+    - A full short string has remaining == 0 which doubles as its '\0' : 23 chars inline
+Append grows capacity geometrically (x2) so repeated += is amortized O(1) per char
+*/
+template<typename AllocT = std::allocator<char>>
+class BasicString {
+    static_assert(std::endian::native == std::endian::little, "Short / long flag lives in the last byte of cap");
+    using AllocTraits = std::allocator_traits<AllocT>;
+    static constexpr bool IS_DEFAULT_ALLOC = std::is_same_v<AllocT, std::allocator<char>>;
+    static constexpr size_t SSO_CAP = 23;
+    static constexpr size_t LONG_FLAG = size_t{1} << 63;
+
+    struct Long {
+        char* ptr;
+        size_t size;
+        size_t cap; // | LONG_FLAG
+    };
+    struct Short {
+        char data[SSO_CAP]{};
+        unsigned char remaining{SSO_CAP};
+    };
+    union {
+        Long m_long;
+        Short m_short{};
+    };
+    [[no_unique_address]] AllocT m_alloc;
+
+    bool isSmall() const {
+        return (m_short.remaining & 0x80) == 0;
     }
     char* alloc(size_t size_) {
-        return new char[size_];
+        if constexpr (IS_DEFAULT_ALLOC) {
+            return new char[size_];
+        }
+        else {
+            return AllocTraits::allocate(m_alloc, size_);
+        }
     }
+    // Heap buffer is always capacity()+1 bytes, leaves string empty and short
     void dealloc() noexcept {
         if (!isSmall()) {
-            delete []getHeapPtr();
-            m_cap = SSO_SIZE-1;
+            if constexpr (IS_DEFAULT_ALLOC) {
+                delete []m_long.ptr;
+            }
+            else {
+                AllocTraits::deallocate(m_alloc, m_long.ptr, capacity()+1);
+            }
+            setSmallEmpty();
         }
     }
-public:
-    String() = default;
-    String(const char* p) {
-        size_t len = std::strlen(p);
-        // Use SSO
-        if (len < SSO_SIZE) {
-            std::memcpy(m_data, p, len+1);
-            m_cap = SSO_SIZE - 1;
-        }
-        // Use Heap
+    void setSmallEmpty() noexcept {
+        m_short.data[0] = '\0';
+        m_short.remaining = SSO_CAP;
+    }
+    void setLong(char* buffer, size_t size_, size_t cap_) noexcept {
+        m_long.ptr = buffer;
+        m_long.size = size_;
+        m_long.cap = cap_ | LONG_FLAG;
+    }
+    // Caller writes the characters, terminator is written here
+    void setSize(size_t size_) noexcept {
+        if (isSmall()) {
+            m_short.remaining = static_cast<unsigned char>(SSO_CAP - size_);
+            if (size_ != SSO_CAP) {
+                m_short.data[size_] = '\0'; // at 23 chars remaining == 0 is the terminator
+            }
+        }
+        else {
+            m_long.size = size_;
+            m_long.ptr[size_] = '\0';
+        }
+    }
+    // Copies p[0..len) into a fresh representation, string must be empty and short
+    void init(const char* p, size_t len) {
+        if (len <= SSO_CAP) {
+            std::memcpy(m_short.data, p, len);
+            setSize(len);
+        }
         else {
-            char* buffer = new char[len+1];
-            std::memcpy(buffer, p, len+1);
-            std::memcpy(m_data, &buffer, sizeof(char*));
-            m_cap = len;
+            char* buffer = alloc(len+1);
+            std::memcpy(buffer, p, len);
+            buffer[len] = '\0';
+            setLong(buffer, len, len);
         }
-        m_size = len;
     }
-    String(char c) {
-        m_data[0] = c;
-        m_data[1] = 0;
-        m_size = 1;
+    // Moves to a heap buffer of newCap chars, existing chars are kept
+    void grow(size_t newCap) {
+        size_t len = size();
+        char* buffer = alloc(newCap+1);
+        std::memcpy(buffer, getCString(), len+1);
+        dealloc();
+        setLong(buffer, len, newCap);
+    }
+    // Swaps representation only, allocators are handled by callers
+    void swapData(BasicString& other) noexcept {
+        char temp[sizeof(Long)];
+        std::memcpy(temp, &m_long, sizeof(Long));
+        std::memcpy(&m_long, &other.m_long, sizeof(Long));
+        std::memcpy(&other.m_long, temp, sizeof(Long));
+    }
+    // Adopts a heap buffer of cap+1 bytes from the same allocator, buffer[size] must be '\0'
+    template<typename> friend class BasicStringBuilder;
+    BasicString(char* buffer, size_t size_, size_t cap_, const AllocT& alloc_) : m_alloc{alloc_} {
+        setLong(buffer, size_, cap_);
+    }
+public:
+    static constexpr size_t npos = NPOS;
+
+    BasicString() = default;
+    explicit BasicString(const AllocT& alloc_) : m_alloc{alloc_} {}
+    BasicString(const char* p, const AllocT& alloc_ = AllocT()) : m_alloc{alloc_} {
+        init(p, std::strlen(p));
+    }
+    BasicString(const char* p, size_t len, const AllocT& alloc_ = AllocT()) : m_alloc{alloc_} {
+        init(p, len);
+    }
+    BasicString(char c, const AllocT& alloc_ = AllocT()) : m_alloc{alloc_} {
+        m_short.data[0] = c;
+        setSize(1);
     }
-    String(const String& other) {
-        // Copy into static buffer
-        if (other.m_size < SSO_SIZE) {
-            std::memcpy(m_data, other.getCString(), other.m_size+1);
-            m_cap = SSO_SIZE - 1;
+    BasicString(const BasicString& other) : m_alloc{AllocTraits::select_on_container_copy_construction(other.m_alloc)} {
+        // Short strings are copied as raw bytes
+        if (other.isSmall()) {
+            m_short = other.m_short;
         }
-        // Copy into Heap
         else {
-            char* buffer = new char[other.m_size+1];
-            std::memcpy(buffer, other.getCString(), other.m_size+1);
-            std::memcpy(m_data, &buffer, sizeof(char*));
-            m_cap = other.m_size;
+            init(other.getCString(), other.size());
         }
-        m_size = other.m_size;
     }
-    String(String&& other) noexcept : m_size{other.m_size}, m_cap{other.m_cap} {
-        std::memcpy(m_data, other.m_data, SSO_SIZE);
-        other.m_size = 0;
-        other.m_cap = SSO_SIZE-1;
-        other.m_data[0] = '\0';
+    // Allocator always moves with the buffer
+    BasicString(BasicString&& other) noexcept : m_alloc{std::move(other.m_alloc)} {
+        std::memcpy(&m_long, &other.m_long, sizeof(Long));
+        other.setSmallEmpty();
     }
-    String& operator=(const String& other) {
+    BasicString& operator=(const BasicString& other) {
         if (this != &other) {
-            if (other.m_size > m_cap) {
-                char* buffer = new char[other.m_size+1];
-                std::memcpy(buffer, other.getCString(), other.m_size+1);        
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+                // Memory from our allocator can not be freed by the new one
+                if (m_alloc != other.m_alloc) {
+                    dealloc();
+                }
+                m_alloc = other.m_alloc;
+            }
+            size_t len = other.size();
+            if (len > capacity()) {
+                char* buffer = alloc(len+1);
+                std::memcpy(buffer, other.getCString(), len+1);
                 dealloc();
-                std::memcpy(m_data, &buffer, sizeof(char*));
-                m_cap = other.m_size;
-            }   
+                setLong(buffer, len, len);
+            }
             else {
-                std::memcpy(getCString(), other.getCString(), other.m_size+1);
+                std::memcpy(getCString(), other.getCString(), len);
+                setSize(len);
             }
-            m_size = other.m_size;
         }
         return *this;
     }
-    String& operator=(String&& other) noexcept {
-        String tmp{std::move(other)};
-        swap(*this, tmp);
+    // noexcept only if buffer can always be stolen
+    BasicString& operator=(BasicString&& other) noexcept(AllocTraits::propagate_on_container_move_assignment::value ||
+                                                         AllocTraits::is_always_equal::value) {
+        if constexpr (!AllocTraits::propagate_on_container_move_assignment::value) {
+            // Different arenas : buffer can't change hands, copy the characters
+            if (m_alloc != other.m_alloc) {
+                return *this = other;
+            }
+        }
+        BasicString tmp{std::move(other)};
+        swapData(tmp);
+        if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+            using std::swap;
+            swap(m_alloc, tmp.m_alloc);
+        }
         return *this;
     }
-    ~String() noexcept {
+    ~BasicString() noexcept {
         dealloc();
     }
     char* getCString() {
-        return (isSmall() ? m_data : getHeapPtr());
+        return (isSmall() ? m_short.data : m_long.ptr);
     }
     const char* getCString() const {
-        return (isSmall() ? m_data : getHeapPtr());
+        return (isSmall() ? m_short.data : m_long.ptr);
+    }
+    std::string_view view() const {
+        return {getCString(), size()};
+    }
+    // Swapping strings with unequal non propagating allocators is undefined, same as std containers
+    friend void swap(BasicString& f, BasicString& s) noexcept {
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(f.m_alloc, s.m_alloc);
+        }
+        else {
+            assert(f.m_alloc == s.m_alloc);
+        }
+        f.swapData(s);
     }
-    friend void swap(String& f, String& s) noexcept {
-        using std::swap;
-        swap(f.m_size, s.m_size);
-        swap(f.m_cap, s.m_cap);
-        char temp[SSO_SIZE];
-        memcpy(temp, f.m_data, SSO_SIZE);
-        memcpy(f.m_data, s.m_data, SSO_SIZE);
-        memcpy(s.m_data, temp, SSO_SIZE);
+    AllocT get_allocator() const {
+        return m_alloc;
     }
     size_t size() const {
-        return m_size;
+        return (isSmall() ? SSO_CAP - m_short.remaining : m_long.size);
+    }
+    size_t capacity() const {
+        return (isSmall() ? SSO_CAP : m_long.cap & ~LONG_FLAG);
     }
     bool empty() const {
-        return m_size == 0;
+        return size() == 0;
+    }
+    void reserve(size_t newCap) {
+        if (newCap > capacity()) {
+            grow(newCap);
+        }
     }
 
-    String& append(const String& other) {
-        size_t newSize = other.m_size + m_size;
-        if (newSize > m_cap) {
-            char* buffer = new char[newSize+1];
-            std::memcpy(buffer, getCString(), m_size);        
-            std::memcpy(buffer+m_size, other.getCString(), other.m_size+1);        
+    // p may point into this string
+    BasicString& append(const char* p, size_t len) {
+        size_t oldSize = size();
+        size_t newSize = oldSize + len;
+        if (newSize > capacity()) {
+            // Geometric growth, old buffer stays alive until p has been copied
+            size_t newCap = std::max(newSize, capacity() << 1);
+            char* buffer = alloc(newCap+1);
+            std::memcpy(buffer, getCString(), oldSize);
+            std::memcpy(buffer+oldSize, p, len);
             dealloc();
-            std::memcpy(m_data, &buffer, sizeof(char*));
-            m_cap = newSize;
-        }   
+            setLong(buffer, oldSize, newCap);
+        }
         else {
-            std::memcpy(getCString()+m_size, other.getCString(), other.m_size+1);
+            std::memcpy(getCString()+oldSize, p, len);
         }
-        m_size = newSize;
+        setSize(newSize);
         return *this;
     }
+    BasicString& append(const BasicString& other) {
+        return append(other.getCString(), other.size());
+    }
+    BasicString& append(const char* p) {
+        return append(p, std::strlen(p));
+    }
+    void push_back(char c) {
+        append(&c, 1);
+    }
 
-    String& operator+=(const String& other) {
+    BasicString& operator+=(const BasicString& other) {
         return append(other);
     }
+    BasicString& operator+=(const char* p) {
+        return append(p);
+    }
+    BasicString& operator+=(char c) {
+        push_back(c);
+        return *this;
+    }
+
+    // Search : returns NPOS if not found
+    size_t find(char c, size_t pos = 0) const {
+        size_t len = size();
+        if (pos >= len) return NPOS;
+        size_t r = stringKernels().findChar(getCString() + pos, len - pos, c);
+        return (r == NPOS ? NPOS : pos + r);
+    }
+    size_t find(std::string_view needle, size_t pos = 0) const {
+        size_t len = size();
+        if (pos > len || needle.size() > len - pos) return NPOS;
+        if (needle.empty()) return pos;
+        if (needle.size() == 1) return find(needle[0], pos);
+        size_t r = stringKernels().findSubstr(getCString() + pos, len - pos, needle.data(), needle.size());
+        return (r == NPOS ? NPOS : pos + r);
+    }
+    size_t find(const BasicString& needle, size_t pos = 0) const {
+        return find(needle.view(), pos);
+    }
+    size_t find(const char* needle, size_t pos = 0) const {
+        return find(std::string_view{needle}, pos);
+    }
+
+    // <0, 0, >0 like strcmp, bytes compare as unsigned
+    int compare(std::string_view other) const {
+        size_t len = size();
+        size_t shared = std::min(len, other.size());
+        // A default constructed string_view has a null data(), memcmp must not see it even with length 0
+        if (shared != 0) {
+            int r = std::memcmp(getCString(), other.data(), shared);
+            if (r != 0) return r;
+        }
+        return (len < other.size() ? -1 : (len > other.size() ? 1 : 0));
+    }
+    int compare(const BasicString& other) const {
+        return compare(other.view());
+    }
+    int compare(const char* other) const {
+        return compare(std::string_view{other});
+    }
+    bool starts_with(std::string_view prefix) const {
+        // Same null data() case as compare
+        if (prefix.empty()) return true;
+        return prefix.size() <= size() && std::memcmp(getCString(), prefix.data(), prefix.size()) == 0;
+    }
+    uint64_t hash() const {
+        return hashBytes(getCString(), size());
+    }
+
+    friend bool operator==(const BasicString& f, const BasicString& s) {
+        return f.size() == s.size() && std::memcmp(f.getCString(), s.getCString(), f.size()) == 0;
+    }
+    friend bool operator<(const BasicString& f, const BasicString& s) {
+        return f.compare(s) < 0;
+    }
+};
+
+// Hashes the characters so String can key std::unordered_map
+template<typename AllocT>
+struct std::hash<BasicString<AllocT>> {
+    size_t operator()(const BasicString<AllocT>& s) const noexcept {
+        return s.hash();
+    }
+};
+
+using String = BasicString<>;
+// String drawing heap buffers from a std::pmr::memory_resource, e.g. a per request arena
+using PmrString = BasicString<std::pmr::polymorphic_allocator<char>>;
+
+/*
+String interning : each distinct string is stored once, users hold a 4 byte Symbol
+    - Symbol equality / hashing is an integer compare, id 0 is the empty / invalid symbol
+    - Characters live in an arena of 64KB chunks (NUL terminated), never moved or freed until the interner dies
+    - Entries {ptr, len} live in a segmented directory (segment k holds BASE << k entries), so an
+      entry never moves and view(Symbol) is lock free at any time
+    - Index : open addressing table of ids keyed by hashBytes, shared_mutex lets lookups run in parallel,
+      intern of a new string takes the exclusive lock
+    - freeze() makes the table read only : lookups skip the lock entirely, interning a new string throws
+*/
+struct Symbol {
+    uint32_t id{0};
+    bool valid() const {
+        return id != 0;
+    }
+    friend bool operator==(Symbol f, Symbol s) {
+        return f.id == s.id;
+    }
+};
+
+template<>
+struct std::hash<Symbol> {
+    size_t operator()(Symbol s) const noexcept {
+        return s.id;
+    }
+};
+
+class StringInterner {
+    struct Entry {
+        const char* ptr;
+        uint32_t len;
+        uint64_t hash;
+    };
+    static constexpr size_t CHUNK_SIZE = 1 << 16;
+    static constexpr size_t ENTRY_BASE = 256;
+    static constexpr size_t MAX_SEGMENTS = 24; // ENTRY_BASE * 2^24 > 2^32 ids
+
+    // Arena
+    std::vector<std::unique_ptr<char[]>> m_chunks;
+    char* m_cur{nullptr};
+    size_t m_left{0};
+    // Entries, id - 1 indexes the directory
+    std::array<std::unique_ptr<Entry[]>, MAX_SEGMENTS> m_entries;
+    uint32_t m_count{0};
+    // Index, 0 is empty slot
+    std::vector<uint32_t> m_table;
+    size_t m_mask{0};
+
+    mutable std::shared_mutex m_lock;
+    std::atomic<bool> m_frozen{false};
+
+    static std::pair<size_t, size_t> locate(size_t idx) {
+        // Segment k starts at ENTRY_BASE * (2^k - 1)
+        size_t seg = static_cast<size_t>(std::bit_width(idx / ENTRY_BASE + 1)) - 1;
+        return {seg, idx - ENTRY_BASE * ((size_t{1} << seg) - 1)};
+    }
+    const Entry& entry(uint32_t id) const {
+        auto [seg, offset] = locate(id - 1);
+        return m_entries[seg][offset];
+    }
+    const char* store(std::string_view s) {
+        size_t need = s.size() + 1;
+        char* dst;
+        // Big strings get their own chunk so they don't waste the rest of the current one
+        if (need > CHUNK_SIZE / 4) {
+            m_chunks.push_back(std::make_unique<char[]>(need));
+            dst = m_chunks.back().get();
+        }
+        else {
+            if (need > m_left) {
+                m_chunks.push_back(std::make_unique<char[]>(CHUNK_SIZE));
+                m_cur = m_chunks.back().get();
+                m_left = CHUNK_SIZE;
+            }
+            dst = m_cur;
+            m_cur += need;
+            m_left -= need;
+        }
+        if (!s.empty()) {
+            std::memcpy(dst, s.data(), s.size());
+        }
+        dst[s.size()] = '\0';
+        return dst;
+    }
+    // Returns id or 0, caller holds the lock or the table is frozen
+    uint32_t lookup(std::string_view s, uint64_t h) const {
+        if (m_table.empty()) return 0;
+        for (size_t slot = h & m_mask; ; slot = (slot + 1) & m_mask) {
+            uint32_t id = m_table[slot];
+            if (id == 0) return 0;
+            const Entry& e = entry(id);
+            if (e.hash == h && e.len == s.size() && (s.empty() || std::memcmp(e.ptr, s.data(), s.size()) == 0)) return id;
+        }
+    }
+    void placeInTable(uint32_t id, uint64_t h) {
+        size_t slot = h & m_mask;
+        while (m_table[slot] != 0) {
+            slot = (slot + 1) & m_mask;
+        }
+        m_table[slot] = id;
+    }
+    void rehash(size_t newSize) {
+        m_table.assign(newSize, 0);
+        m_mask = newSize - 1;
+        for (uint32_t id = 1; id <= m_count; id++) {
+            placeInTable(id, entry(id).hash);
+        }
+    }
+    // Caller holds the exclusive lock
+    uint32_t insert(std::string_view s, uint64_t h) {
+        if (s.size() > std::numeric_limits<uint32_t>::max() || m_count == std::numeric_limits<uint32_t>::max()) {
+            throw std::length_error("StringInterner is full");
+        }
+        // Keep load factor <= 1/2
+        if ((size_t{m_count} + 1) * 2 > m_table.size()) {
+            rehash(std::max<size_t>(64, m_table.size() * 2));
+        }
+        auto [seg, offset] = locate(m_count);
+        if (!m_entries[seg]) {
+            m_entries[seg] = std::make_unique<Entry[]>(ENTRY_BASE << seg);
+        }
+        m_entries[seg][offset] = Entry{store(s), static_cast<uint32_t>(s.size()), h};
+        uint32_t id = ++m_count;
+        placeInTable(id, h);
+        return id;
+    }
+public:
+    StringInterner() = default;
+    // Rule of 5 : symbols refer to this table, disable copy / move
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+    // Rule of 5 end
+
+    // Returns the existing symbol or stores s, throws std::logic_error for a new string once frozen
+    Symbol intern(std::string_view s) {
+        uint64_t h = hashBytes(s.data(), s.size());
+        if (m_frozen.load(std::memory_order_acquire)) {
+            uint32_t id = lookup(s, h);
+            if (id == 0) {
+                throw std::logic_error("StringInterner is frozen");
+            }
+            return Symbol{id};
+        }
+        {
+            std::shared_lock<std::shared_mutex> guard{m_lock};
+            if (uint32_t id = lookup(s, h)) {
+                return Symbol{id};
+            }
+        }
+        std::unique_lock<std::shared_mutex> guard{m_lock};
+        // Someone may have inserted it between the two locks
+        if (uint32_t id = lookup(s, h)) {
+            return Symbol{id};
+        }
+        // Or frozen it : lock free readers must never see the table change after freeze()
+        if (m_frozen.load(std::memory_order_relaxed)) {
+            throw std::logic_error("StringInterner is frozen");
+        }
+        return Symbol{insert(s, h)};
+    }
+    template<typename AllocT>
+    Symbol intern(const BasicString<AllocT>& s) {
+        return intern(s.view());
+    }
+
+    // Returns invalid symbol if s was never interned
+    Symbol find(std::string_view s) const {
+        uint64_t h = hashBytes(s.data(), s.size());
+        if (m_frozen.load(std::memory_order_acquire)) {
+            return Symbol{lookup(s, h)};
+        }
+        std::shared_lock<std::shared_mutex> guard{m_lock};
+        return Symbol{lookup(s, h)};
+    }
+
+    // Lock free, symbol must come from this interner
+    std::string_view view(Symbol sym) const {
+        if (!sym.valid()) return {};
+        const Entry& e = entry(sym.id);
+        return {e.ptr, e.len};
+    }
+    const char* getCString(Symbol sym) const {
+        return sym.valid() ? entry(sym.id).ptr : "";
+    }
+    String str(Symbol sym) const {
+        std::string_view v = view(sym);
+        return String{v.data(), v.size()};
+    }
+
+    // One way : no more inserts, lookups stop locking
+    void freeze() {
+        std::unique_lock<std::shared_mutex> guard{m_lock};
+        m_frozen.store(true, std::memory_order_release);
+    }
+    bool frozen() const {
+        return m_frozen.load(std::memory_order_acquire);
+    }
+    size_t size() const {
+        std::shared_lock<std::shared_mutex> guard{m_lock};
+        return m_count;
+    }
+};
+
+/*
+StringBuilder : appends and formats into one growable buffer, finish() hands it to a String
+    - Buffer comes from the same AllocT protocol as BasicString (capacity+1 bytes), so a long
+      result is adopted by the String without a copy, PmrStringBuilder + monotonic_buffer_resource
+      gives an arena backed builder
+    - Results that fit the 23 char inline buffer are copied instead and the buffer is kept, so a
+      builder reused for short lines does not allocate per line
+    - Integers : digit count from a table indexed by bit width, then two digits per step from a
+      "00".."99" table written backwards
+    - Doubles : std::to_chars, shortest representation that round trips
+*/
+inline constexpr char DIGIT_PAIRS[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Number of decimal digits in v
+inline uint32_t countDigits(uint64_t v) {
+    static constexpr uint64_t POW10[] = {
+        1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull,
+        1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull,
+        100000000000000ull, 1000000000000000ull, 10000000000000000ull, 100000000000000000ull,
+        1000000000000000000ull, 10000000000000000000ull};
+    // log10(v) ~ bit_width * 1233 / 4096, off by at most one : fix with one compare
+    uint32_t approx = (static_cast<uint32_t>(std::bit_width(v | 1)) * 1233) >> 12;
+    return approx + 1 - ((v | 1) < POW10[approx]); // v | 1 so 0 has one digit
+}
+// Writes v into [dst, dst+nDigits) from the back
+inline void writeDigits(char* dst, uint64_t v, uint32_t nDigits) {
+    char* p = dst + nDigits;
+    while (v >= 100) {
+        uint64_t idx = (v % 100) * 2;
+        v /= 100;
+        p -= 2;
+        std::memcpy(p, DIGIT_PAIRS + idx, 2);
+    }
+    if (v >= 10) {
+        std::memcpy(p - 2, DIGIT_PAIRS + v * 2, 2);
+    }
+    else {
+        p[-1] = static_cast<char>('0' + v);
+    }
+}
+
+template<typename AllocT = std::allocator<char>>
+class BasicStringBuilder {
+    using AllocTraits = std::allocator_traits<AllocT>;
+    static constexpr bool IS_DEFAULT_ALLOC = std::is_same_v<AllocT, std::allocator<char>>;
+    static constexpr size_t MIN_CAP = 64;
+
+    char* m_buf{nullptr};
+    size_t m_size{0};
+    size_t m_cap{0}; // buffer is m_cap+1 bytes
+    [[no_unique_address]] AllocT m_alloc;
+
+    char* alloc(size_t size_) {
+        if constexpr (IS_DEFAULT_ALLOC) {
+            return new char[size_];
+        }
+        else {
+            return AllocTraits::allocate(m_alloc, size_);
+        }
+    }
+    void dealloc() noexcept {
+        if (m_buf != nullptr) {
+            if constexpr (IS_DEFAULT_ALLOC) {
+                delete []m_buf;
+            }
+            else {
+                AllocTraits::deallocate(m_alloc, m_buf, m_cap+1);
+            }
+            m_buf = nullptr;
+            m_cap = 0;
+        }
+    }
+    void grow(size_t minCap) {
+        size_t newCap = std::max({minCap, m_cap << 1, MIN_CAP});
+        char* buffer = alloc(newCap+1);
+        if (m_size != 0) {
+            std::memcpy(buffer, m_buf, m_size);
+        }
+        dealloc();
+        m_buf = buffer;
+        m_cap = newCap;
+    }
+    // Returns pointer to n writable chars at the end
+    char* reserveTail(size_t n) {
+        if (m_size + n > m_cap) [[unlikely]] {
+            grow(m_size + n);
+        }
+        return m_buf + m_size;
+    }
+public:
+    explicit BasicStringBuilder(size_t cap = 0, const AllocT& alloc_ = AllocT()) : m_alloc{alloc_} {
+        if (cap != 0) {
+            grow(cap);
+        }
+    }
+    // Rule of 5 : builders are scratch objects, disable copy / move
+    ~BasicStringBuilder() {
+        dealloc();
+    }
+    BasicStringBuilder(const BasicStringBuilder&) = delete;
+    BasicStringBuilder& operator=(const BasicStringBuilder&) = delete;
+    // Rule of 5 end
+
+    BasicStringBuilder& append(const char* p, size_t len) {
+        if (len == 0) return *this; // p may be a null string_view data()
+        std::memcpy(reserveTail(len), p, len);
+        m_size += len;
+        return *this;
+    }
+    BasicStringBuilder& append(std::string_view s) {
+        return append(s.data(), s.size());
+    }
+    BasicStringBuilder& append(const BasicString<AllocT>& s) {
+        return append(s.getCString(), s.size());
+    }
+    BasicStringBuilder& append(char c) {
+        *reserveTail(1) = c;
+        m_size++;
+        return *this;
+    }
+    BasicStringBuilder& appendUInt(uint64_t v) {
+        uint32_t nDigits = countDigits(v);
+        writeDigits(reserveTail(nDigits), v, nDigits);
+        m_size += nDigits;
+        return *this;
+    }
+    BasicStringBuilder& appendInt(int64_t v) {
+        // Negate in unsigned so INT64_MIN does not overflow
+        uint64_t mag = static_cast<uint64_t>(v);
+        if (v < 0) {
+            append('-');
+            mag = ~mag + 1;
+        }
+        return appendUInt(mag);
+    }
+    BasicStringBuilder& appendDouble(double v) {
+        constexpr size_t MAX_DOUBLE_CHARS = 32; // "-1.2345678901234567e-308"
+        char* dst = reserveTail(MAX_DOUBLE_CHARS);
+        auto [end, ec] = std::to_chars(dst, dst + MAX_DOUBLE_CHARS, v);
+        assert(ec == std::errc{});
+        m_size += static_cast<size_t>(end - dst);
+        return *this;
+    }
+
+    BasicStringBuilder& operator<<(std::string_view s) {
+        return append(s);
+    }
+    BasicStringBuilder& operator<<(const char* s) {
+        return append(std::string_view{s});
+    }
+    BasicStringBuilder& operator<<(char c) {
+        return append(c);
+    }
+    template<typename IntT> requires std::is_integral_v<IntT>
+    BasicStringBuilder& operator<<(IntT v) {
+        if constexpr (std::is_signed_v<IntT>) {
+            return appendInt(v);
+        }
+        else {
+            return appendUInt(v);
+        }
+    }
+    BasicStringBuilder& operator<<(double v) {
+        return appendDouble(v);
+    }
+
+    std::string_view view() const {
+        return {m_buf, m_size};
+    }
+    size_t size() const {
+        return m_size;
+    }
+    // Keeps the buffer for the next line
+    void clear() {
+        m_size = 0;
+    }
+
+    // Hands the characters to a String, long results take the buffer itself
+    BasicString<AllocT> finish() {
+        if (m_size <= BasicString<AllocT>::SSO_CAP) {
+            BasicString<AllocT> out{m_buf ? m_buf : "", m_size, m_alloc};
+            m_size = 0;
+            return out;
+        }
+        m_buf[m_size] = '\0';
+        BasicString<AllocT> out{m_buf, m_size, m_cap, m_alloc};
+        m_buf = nullptr;
+        m_size = 0;
+        m_cap = 0;
+        return out;
+    }
+};
+
+using StringBuilder = BasicStringBuilder<>;
+using PmrStringBuilder = BasicStringBuilder<std::pmr::polymorphic_allocator<char>>;
+
+/*
+Rope : immutable balanced tree over refcounted String chunks
+    - Leaves point into a shared chunk (offset, len), so substr and copies never copy characters
+    - Concat nodes are joined AVL style (children depths differ by at most one), append / concat
+      rebuilds only the O(log n) nodes along one spine and shares everything else
+    - flatten() copies into one String on demand, iovecs() exposes the chunks for writev
+*/
+class Rope {
+    struct Node;
+    using NodePtr = std::shared_ptr<const Node>;
+    struct Node {
+        NodePtr left;
+        NodePtr right;
+        std::shared_ptr<const String> chunk; // Leaf only
+        size_t offset{0}; // Leaf only
+        size_t len{0};
+        int depth{0}; // Leaves are 0
+    };
+    NodePtr m_root;
+
+    static int depthOf(const NodePtr& n) {
+        return n ? n->depth : -1;
+    }
+    static NodePtr makeLeaf(std::shared_ptr<const String> chunk, size_t offset, size_t len) {
+        auto n = std::make_shared<Node>();
+        n->chunk = std::move(chunk);
+        n->offset = offset;
+        n->len = len;
+        return n;
+    }
+    static NodePtr makeConcat(NodePtr l, NodePtr r) {
+        auto n = std::make_shared<Node>();
+        n->len = l->len + r->len;
+        n->depth = std::max(l->depth, r->depth) + 1;
+        n->left = std::move(l);
+        n->right = std::move(r);
+        return n;
+    }
+    static NodePtr rotateLeft(const NodePtr& n) {
+        return makeConcat(makeConcat(n->left, n->right->left), n->right->right);
+    }
+    static NodePtr rotateRight(const NodePtr& n) {
+        return makeConcat(n->left->left, makeConcat(n->left->right, n->right));
+    }
+    // l is deeper than r by more than one : walk down l's right spine
+    static NodePtr joinRight(const NodePtr& l, const NodePtr& r) {
+        if (depthOf(l->right) <= depthOf(r) + 1) {
+            NodePtr t = makeConcat(l->right, r);
+            if (t->depth <= depthOf(l->left) + 1) {
+                return makeConcat(l->left, t);
+            }
+            return rotateLeft(makeConcat(l->left, rotateRight(t)));
+        }
+        NodePtr t = joinRight(l->right, r);
+        NodePtr res = makeConcat(l->left, t);
+        return (t->depth <= depthOf(l->left) + 1 ? res : rotateLeft(res));
+    }
+    static NodePtr joinLeft(const NodePtr& l, const NodePtr& r) {
+        if (depthOf(r->left) <= depthOf(l) + 1) {
+            NodePtr t = makeConcat(l, r->left);
+            if (t->depth <= depthOf(r->right) + 1) {
+                return makeConcat(t, r->right);
+            }
+            return rotateRight(makeConcat(rotateLeft(t), r->right));
+        }
+        NodePtr t = joinLeft(l, r->left);
+        NodePtr res = makeConcat(t, r->right);
+        return (t->depth <= depthOf(r->right) + 1 ? res : rotateRight(res));
+    }
+    static NodePtr join(const NodePtr& l, const NodePtr& r) {
+        if (!l || l->len == 0) return r;
+        if (!r || r->len == 0) return l;
+        if (l->depth > r->depth + 1) return joinRight(l, r);
+        if (r->depth > l->depth + 1) return joinLeft(l, r);
+        return makeConcat(l, r);
+    }
+    // [pos, pos+len) of n, shares every node fully inside the range
+    static NodePtr slice(const NodePtr& n, size_t pos, size_t len) {
+        if (len == 0) return nullptr;
+        if (pos == 0 && len == n->len) return n;
+        if (n->chunk) {
+            return makeLeaf(n->chunk, n->offset + pos, len);
+        }
+        size_t leftLen = n->left->len;
+        if (pos + len <= leftLen) return slice(n->left, pos, len);
+        if (pos >= leftLen) return slice(n->right, pos - leftLen, len);
+        return join(slice(n->left, pos, leftLen - pos), slice(n->right, 0, pos + len - leftLen));
+    }
+    template<typename FnT>
+    static void walk(const NodePtr& n, FnT& fn) {
+        if (!n) return;
+        if (n->chunk) {
+            fn(n->chunk->getCString() + n->offset, n->len);
+            return;
+        }
+        walk(n->left, fn);
+        walk(n->right, fn);
+    }
+    explicit Rope(NodePtr root) : m_root{std::move(root)} {}
+public:
+    Rope() = default;
+    // Takes ownership of s as one chunk
+    explicit Rope(String s) {
+        size_t len = s.size();
+        if (len != 0) {
+            m_root = makeLeaf(std::make_shared<const String>(std::move(s)), 0, len);
+        }
+    }
+    explicit Rope(std::string_view s) : Rope(String{s.data(), s.size()}) {}
+
+    size_t size() const {
+        return m_root ? m_root->len : 0;
+    }
+    bool empty() const {
+        return size() == 0;
+    }
+    int depth() const {
+        return depthOf(m_root);
+    }
+
+    Rope& append(const Rope& other) {
+        m_root = join(m_root, other.m_root);
+        return *this;
+    }
+    Rope& append(String s) {
+        return append(Rope{std::move(s)});
+    }
+    Rope& operator+=(const Rope& other) {
+        return append(other);
+    }
+    friend Rope operator+(const Rope& f, const Rope& s) {
+        return Rope{join(f.m_root, s.m_root)};
+    }
+
+    // Zero copy, len is clamped to the end like std::string::substr
+    Rope substr(size_t pos, size_t len = NPOS) const {
+        if (pos > size()) {
+            throw std::out_of_range("Rope::substr");
+        }
+        len = std::min(len, size() - pos);
+        return Rope{m_root ? slice(m_root, pos, len) : nullptr};
+    }
+    char at(size_t pos) const {
+        if (pos >= size()) {
+            throw std::out_of_range("Rope::at");
+        }
+        const Node* n = m_root.get();
+        while (!n->chunk) {
+            if (pos < n->left->len) {
+                n = n->left.get();
+            }
+            else {
+                pos -= n->left->len;
+                n = n->right.get();
+            }
+        }
+        return n->chunk->getCString()[n->offset + pos];
+    }
+
+    // fn(const char* data, size_t len) for every chunk in order
+    template<typename FnT>
+    void forEachChunk(FnT fn) const {
+        walk(m_root, fn);
+    }
+    String flatten() const {
+        String out;
+        out.reserve(size());
+        forEachChunk([&out](const char* p, size_t len) { out.append(p, len); });
+        return out;
+    }
+#ifdef __linux__
+    // Chunks as iovecs for writev, valid while this rope is alive
+    std::vector<iovec> iovecs() const {
+        std::vector<iovec> out;
+        forEachChunk([&out](const char* p, size_t len) {
+            out.push_back(iovec{const_cast<char*>(p), len});
+        });
+        return out;
+    }
+#endif
 };
 
 int main() {
@@ -172,4 +1132,603 @@ int main() {
     o += "is a good boy";
     std::cout << o.getCString() << '\n';
 
+    // Allocator propagation
+    {
+        static_assert(sizeof(String) == 24); // default allocator takes no space
+        std::pmr::monotonic_buffer_resource arena1;
+        std::pmr::monotonic_buffer_resource arena2;
+        PmrString p1{"kept in arena one, long enough to not use sso", &arena1};
+        PmrString p2{"b", &arena2};
+        p2 = std::move(p1); // polymorphic_allocator does not propagate : characters are copied
+        assert(p2.get_allocator().resource() == &arena2);
+        assert(std::strcmp(p2.getCString(), "kept in arena one, long enough to not use sso") == 0);
+        PmrString p3{p2}; // copy construction goes to the default resource
+        assert(p3.get_allocator().resource() == std::pmr::get_default_resource());
+        PmrString p4{std::move(p2)}; // move construction always takes the allocator
+        assert(p4.get_allocator().resource() == &arena2 && p2.empty());
+        PmrString p5{"c", &arena2};
+        swap(p4, p5);
+        assert(p4.size() == 1 && p5.size() == 45);
+        p5.append(PmrString{" and appended", &arena2});
+        assert(p5.size() == 58);
+    }
+
+    // Short / long boundary
+    {
+        String s22{"0123456789012345678901"};
+        String s23{"01234567890123456789012"};
+        String s24{"012345678901234567890123"};
+        assert(s22.size() == 22 && s22.capacity() == 23);
+        assert(s23.size() == 23 && s23.capacity() == 23 && s23.getCString()[23] == '\0');
+        assert(s24.size() == 24 && s24.capacity() == 24);
+        s22 += 'x'; // fills inline buffer
+        assert(s22.capacity() == 23 && s22.view() == "0123456789012345678901x");
+        s22 += 'y'; // spills, capacity doubles
+        assert(s22.size() == 24 && s22.capacity() == 46);
+        String copy{s23};
+        assert(copy == s23 && !(copy == s24));
+        copy.append(copy); // self append across the boundary
+        assert(copy.size() == 46 && copy.view().substr(23) == s23.view());
+        String e;
+        size_t reallocs = 0;
+        for (int i = 0; i < 1000; i++) {
+            size_t cap = e.capacity();
+            e += "ab";
+            reallocs += (e.capacity() != cap);
+        }
+        assert(e.size() == 2000 && reallocs < 10);
+        String moved{std::move(e)};
+        assert(e.empty() && e.capacity() == 23 && moved.size() == 2000);
+    }
+
+    // Search / compare / hash
+    {
+        String log{"2024-01-01 INFO request served in 12ms\n2024-01-01 ERROR disk full\n"};
+        assert(log.find('\n') == 38 && log.find('\n', 39) == log.size() - 1 && log.find('#') == String::npos);
+        assert(log.find("ERROR") == 50 && log.find("ERROR", 51) == String::npos);
+        assert(log.find("") == 0 && log.find("full\n") == log.size() - 5 && log.find("fullest") == String::npos);
+        assert(log.starts_with("2024") && !log.starts_with("2025"));
+        assert(String{"abc"}.compare("abd") < 0 && String{"abc"}.compare("ab") > 0 && String{"abc"}.compare("abc") == 0);
+        assert(String{"\xff"}.compare("a") > 0); // unsigned bytes
+        assert(String{}.compare(std::string_view{}) == 0 && String{"a"}.compare(std::string_view{}) > 0); // null data()
+        assert(String{}.starts_with(std::string_view{}) && String{"a"}.starts_with(std::string_view{}));
+        assert(String{"same text here, long enough for heap"}.hash() == String{"same text here, long enough for heap"}.hash());
+        assert(String{"a"}.hash() != String{"b"}.hash() && String{""}.hash() != String("\0", 1).hash());
+
+        // Every kernel agrees with std::string_view::find
+        std::mt19937 rng{7};
+        for (int iter = 0; iter < 2000; iter++) {
+            size_t n = rng() % 200;
+            std::string text(n, 'a');
+            for (char& c : text) {
+                c = static_cast<char>('a' + rng() % 3);
+            }
+            std::string needle(1 + rng() % 6, 'a');
+            for (char& c : needle) {
+                c = static_cast<char>('a' + rng() % 3);
+            }
+            size_t expectChar = std::string_view{text}.find('c');
+            size_t expectSub = std::string_view{text}.find(needle);
+            assert(findCharScalar(text.data(), n, 'c') == expectChar);
+            if (needle.size() >= 2 && needle.size() <= n) {
+                assert(findSubstrScalar(text.data(), n, needle.data(), needle.size()) == expectSub);
+            }
+#if defined(__x86_64__)
+            assert(findCharSse2(text.data(), n, 'c') == expectChar);
+            if (needle.size() >= 2 && needle.size() <= n) {
+                assert(findSubstrSse2(text.data(), n, needle.data(), needle.size()) == expectSub);
+            }
+            if (__builtin_cpu_supports("avx2")) {
+                assert(findCharAvx2(text.data(), n, 'c') == expectChar);
+                if (needle.size() >= 2 && needle.size() <= n) {
+                    assert(findSubstrAvx2(text.data(), n, needle.data(), needle.size()) == expectSub);
+                }
+            }
+#endif
+            assert(String(text.data(), n).find(needle.c_str()) == expectSub);
+        }
+    }
+
+    // Interning
+    {
+        StringInterner pool;
+        Symbol a = pool.intern("service.http.request.latency");
+        Symbol b = pool.intern(String{"service.http.request.latency"});
+        Symbol c = pool.intern("service.http.request.count");
+        assert(a.valid() && a == b && !(a == c));
+        assert(pool.view(a) == "service.http.request.latency" && pool.size() == 2);
+        assert(pool.str(c) == String{"service.http.request.count"});
+        assert(!pool.find("never.interned").valid() && pool.find("service.http.request.count") == c);
+        assert(pool.intern("") == pool.intern("") && pool.view(pool.intern("")).empty());
+        assert(pool.intern(std::string_view{}) == pool.intern(""));
+        assert(pool.view(Symbol{}).empty());
+        // Enough to rehash and spill into several entry segments, views stay valid
+        std::vector<Symbol> syms;
+        for (int i = 0; i < 5000; i++) {
+            syms.push_back(pool.intern("tag." + std::to_string(i)));
+        }
+        assert(pool.view(a) == "service.http.request.latency");
+        for (int i = 0; i < 5000; i++) {
+            assert(pool.view(syms[i]) == "tag." + std::to_string(i) && pool.intern("tag." + std::to_string(i)) == syms[i]);
+        }
+        // Big string goes to its own chunk
+        std::string big(100'000, 'x');
+        assert(pool.view(pool.intern(big)) == big);
+
+        pool.freeze();
+        assert(pool.frozen() && pool.intern("tag.42") == syms[42]);
+        bool threw = false;
+        try {
+            pool.intern("brand.new.tag");
+        }
+        catch (const std::logic_error&) {
+            threw = true;
+        }
+        assert(threw && !pool.find("brand.new.tag").valid());
+
+        // freeze() racing with inserts : once frozen the table never grows
+        StringInterner racing;
+        std::atomic<size_t> inserted{0};
+        std::thread writer([&racing, &inserted]() {
+            for (int i = 0; i < 20'000; i++) {
+                try {
+                    racing.intern("race." + std::to_string(i));
+                    inserted.fetch_add(1, std::memory_order_relaxed);
+                }
+                catch (const std::logic_error&) {
+                }
+            }
+        });
+        while (inserted.load(std::memory_order_relaxed) < 100) {
+            std::this_thread::yield();
+        }
+        racing.freeze();
+        size_t frozenSize = racing.size();
+        writer.join();
+        assert(racing.size() == frozenSize && inserted.load() == frozenSize);
+    }
+    {
+        // Threads intern overlapping names : every name ends up with exactly one id
+        StringInterner pool;
+        std::vector<std::vector<Symbol>> results(4);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; t++) {
+            threads.emplace_back([&pool, &results, t]() {
+                for (int i = 0; i < 20'000; i++) {
+                    results[t].push_back(pool.intern("metric.name." + std::to_string((i * (t + 1)) % 3000)));
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        assert(pool.size() == 3000);
+        for (int t = 0; t < 4; t++) {
+            for (int i = 0; i < 20'000; i++) {
+                assert(pool.view(results[t][i]) == "metric.name." + std::to_string((i * (t + 1)) % 3000));
+            }
+        }
+    }
+
+    // Rope
+    {
+        Rope r{std::string_view{"hello "}};
+        r += Rope{String{"rope "}};
+        r.append(String{"world"});
+        assert(r.size() == 16 && r.at(6) == 'r' && r.flatten() == String{"hello rope world"});
+        Rope mid = r.substr(6, 4);
+        assert(mid.flatten() == String{"rope"} && r.substr(11).flatten() == String{"world"});
+        assert((mid + r.substr(0, 6)).flatten() == String{"ropehello "});
+        assert(r.substr(16).empty() && Rope{}.flatten().empty());
+        std::string joined;
+        r.forEachChunk([&joined](const char* p, size_t len) { joined.append(p, len); });
+        assert(joined == "hello rope world");
+
+        // Random concat / slice against std::string, tree stays balanced
+        std::mt19937 rng{11};
+        std::vector<std::pair<Rope, std::string>> pool;
+        for (int i = 0; i < 64; i++) {
+            std::string s(1 + rng() % 20, static_cast<char>('a' + i % 26));
+            pool.emplace_back(Rope{std::string_view{s}}, s);
+        }
+        for (int iter = 0; iter < 3000; iter++) {
+            auto& a = pool[rng() % pool.size()];
+            auto& b = pool[rng() % pool.size()];
+            Rope rope = a.first + b.first;
+            std::string str = a.second + b.second;
+            // Slice now and then, and always once large so sizes don't double forever
+            if ((rng() % 3 == 0 || str.size() > 4096) && !str.empty()) {
+                size_t pos = rng() % str.size();
+                size_t len = rng() % (str.size() - pos + 1);
+                rope = rope.substr(pos, len);
+                str = str.substr(pos, len);
+            }
+            assert(rope.size() == str.size() && rope.flatten().view() == str);
+            // AVL : depth <= 1.45 log2(chunks + 2)
+            size_t chunks = 0;
+            rope.forEachChunk([&chunks](const char*, size_t) { chunks++; });
+            assert(rope.depth() <= 1.45 * std::log2(chunks + 2));
+            pool[rng() % pool.size()] = {rope, str};
+        }
+    }
+
+    // StringBuilder
+    {
+        StringBuilder sb;
+        for (int64_t v : {int64_t{0}, int64_t{7}, int64_t{-9}, int64_t{10}, int64_t{99}, int64_t{100}, int64_t{-12345},
+                          int64_t{1000000007}, std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::min()}) {
+            sb.clear();
+            sb << v;
+            assert(sb.view() == std::to_string(v));
+        }
+        sb.clear();
+        sb << std::numeric_limits<uint64_t>::max() << ' ' << 9999999999999999999ull << ' ' << 10000000000000000000ull;
+        assert(sb.view() == "18446744073709551615 9999999999999999999 10000000000000000000");
+        std::mt19937_64 rng64{9};
+        for (int i = 0; i < 10000; i++) {
+            uint64_t v = rng64() >> (rng64() % 64);
+            sb.clear();
+            sb.appendUInt(v);
+            assert(sb.view() == std::to_string(v));
+            // Shortest double still parses back to the same value
+            double d = std::ldexp(static_cast<double>(rng64()), static_cast<int>(rng64() % 200) - 100) * (i % 2 ? 1 : -1);
+            sb.clear();
+            sb << d;
+            assert(std::strtod(String(sb.view().data(), sb.size()).getCString(), nullptr) == d);
+        }
+        sb.clear();
+        sb << 0.1 << ' ' << 1e300 << ' ' << -0.0;
+        assert(sb.view() == "0.1 1e+300 -0");
+
+        // Short result is copied inline and the buffer stays for reuse
+        sb.clear();
+        sb << "id=" << 42;
+        String small = sb.finish();
+        assert(small == String{"id=42"} && small.capacity() == 23 && sb.size() == 0);
+        // Long result takes the buffer without a copy
+        sb << "a line long enough to not fit inline, value=" << 3.5;
+        const char* data = sb.view().data();
+        String line = sb.finish();
+        assert(line.getCString() == data && line.view() == "a line long enough to not fit inline, value=3.5");
+        sb << "builder is usable again after finish";
+        assert(sb.finish().size() == 36);
+
+        // Arena backed
+        std::pmr::monotonic_buffer_resource arena;
+        PmrStringBuilder psb{0, &arena};
+        psb << "arena line " << 123456789 << " with enough text to go long";
+        PmrString pline = psb.finish();
+        assert(pline.get_allocator().resource() == &arena && pline.size() == 48);
+    }
+
+    // Benchmark : default heap vs per request arena
+    {
+        size_t nRequests = 100'000;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t r = 0; r < nRequests; r++) {
+            String line{"request line that is long enough to live on heap "};
+            for (int i = 0; i < 10; i++) {
+                line += "header: value; ";
+            }
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        std::cout << "String default heap took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+
+        start = std::chrono::high_resolution_clock::now();
+        std::array<std::byte, 1 << 14> buffer;
+        for (size_t r = 0; r < nRequests; r++) {
+            std::pmr::monotonic_buffer_resource arena{buffer.data(), buffer.size()};
+            PmrString line{"request line that is long enough to live on heap ", &arena};
+            for (int i = 0; i < 10; i++) {
+                line += PmrString{"header: value; ", &arena};
+            }
+        }
+        end = std::chrono::high_resolution_clock::now();
+        std::cout << "String arena took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+    }
+
+    // Benchmark : log line building, many small appends
+    {
+        size_t nLines = 1'000'000;
+        size_t total = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t r = 0; r < nLines; r++) {
+            String line{"2024-01-01T00:00:00Z"};
+            line += " INFO ";
+            for (int i = 0; i < 12; i++) {
+                line += "key=value ";
+            }
+            line += '\n';
+            total += line.size();
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        std::cout << "String log lines took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t r = 0; r < nLines; r++) {
+            std::string line{"2024-01-01T00:00:00Z"};
+            line += " INFO ";
+            for (int i = 0; i < 12; i++) {
+                line += "key=value ";
+            }
+            line += '\n';
+            total -= line.size();
+        }
+        end = std::chrono::high_resolution_clock::now();
+        std::cout << "std::string log lines took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+        assert(total == 0);
+    }
+
+    // Benchmark : log scanning, count lines and ERROR lines in ~64MB
+    {
+        std::string text;
+        std::mt19937 rng{1};
+        const char* levels[] = {"INFO", "DEBUG", "WARN", "ERROR"};
+        while (text.size() < (size_t{64} << 20)) {
+            text += "2024-01-01T00:00:00Z ";
+            text += levels[rng() % 16 == 0 ? 3 : rng() % 3];
+            text += " worker=" + std::to_string(rng() % 64) + " request served from cache, latency_us=" + std::to_string(rng() % 5000) + "\n";
+        }
+        String log{text.data(), text.size()};
+        size_t lines[3]{}, errors[3]{};
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t pos = log.find('\n'); pos != String::npos; pos = log.find('\n', pos + 1)) lines[0]++;
+        for (size_t pos = log.find("ERROR"); pos != String::npos; pos = log.find("ERROR", pos + 5)) errors[0]++;
+        auto end = std::chrono::high_resolution_clock::now();
+        std::cout << "String find took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+
+        start = std::chrono::high_resolution_clock::now();
+        const char* base = text.data();
+        const char* stop = base + text.size();
+        for (const char* p = base; (p = static_cast<const char*>(std::memchr(p, '\n', stop - p))) != nullptr; p++) lines[1]++;
+        for (const char* p = base; (p = static_cast<const char*>(memmem(p, stop - p, "ERROR", 5))) != nullptr; p += 5) errors[1]++;
+        end = std::chrono::high_resolution_clock::now();
+        std::cout << "memchr / memmem took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t pos = text.find('\n'); pos != std::string::npos; pos = text.find('\n', pos + 1)) lines[2]++;
+        for (size_t pos = text.find("ERROR"); pos != std::string::npos; pos = text.find("ERROR", pos + 5)) errors[2]++;
+        end = std::chrono::high_resolution_clock::now();
+        std::cout << "std::string find took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+        assert(lines[0] == lines[1] && lines[1] == lines[2] && errors[0] == errors[1] && errors[1] == errors[2]);
+    }
+
+    // Benchmark : hashing short keys
+    {
+        size_t nKeys = 10'000'000;
+        std::vector<String> keys;
+        std::vector<std::string> stdKeys;
+        keys.reserve(nKeys);
+        stdKeys.reserve(nKeys);
+        char key[32];
+        for (size_t i = 0; i < nKeys; i++) {
+            int len = std::snprintf(key, sizeof(key), "session:user:%08zu", i);
+            keys.emplace_back(key, static_cast<size_t>(len));
+            stdKeys.emplace_back(key, static_cast<size_t>(len));
+        }
+        uint64_t acc = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (const String& k : keys) acc += k.hash();
+        auto end = std::chrono::high_resolution_clock::now();
+        std::cout << "String hash took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+        start = std::chrono::high_resolution_clock::now();
+        for (const std::string& k : stdKeys) acc += std::hash<std::string>{}(k);
+        end = std::chrono::high_resolution_clock::now();
+        std::cout << "std::hash<std::string> took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+        std::cout << (acc & 1) << '\n';
+    }
+
+    // Benchmark : 10M tag occurrences drawn from 10k distinct names, copies vs interned symbols
+    {
+        size_t nDistinct = 10'000, nTags = 10'000'000;
+        std::vector<std::string> names;
+        for (size_t i = 0; i < nDistinct; i++) {
+            names.push_back("service.component.metric.tag_" + std::to_string(i));
+        }
+        std::mt19937 rng{3};
+        std::vector<uint32_t> picks(nTags);
+        for (auto& p : picks) {
+            p = static_cast<uint32_t>(rng() % nDistinct);
+        }
+        std::vector<String> sources;
+        for (const auto& name : names) {
+            sources.emplace_back(name.data(), name.size());
+        }
+
+        size_t matches[2]{};
+        auto start = std::chrono::high_resolution_clock::now();
+        {
+            std::vector<String> tags;
+            tags.reserve(nTags);
+            for (uint32_t p : picks) {
+                tags.push_back(sources[p]); // copy allocates, names are past 23 chars
+            }
+            for (const String& t : tags) {
+                matches[0] += (t == sources[42]);
+            }
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        std::cout << "String copies took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+
+        start = std::chrono::high_resolution_clock::now();
+        {
+            StringInterner pool;
+            std::vector<Symbol> tags;
+            tags.reserve(nTags);
+            for (uint32_t p : picks) {
+                tags.push_back(pool.intern(sources[p]));
+            }
+            Symbol target = pool.find(sources[42].view());
+            for (Symbol t : tags) {
+                matches[1] += (t == target);
+            }
+        }
+        end = std::chrono::high_resolution_clock::now();
+        std::cout << "StringInterner symbols took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+        assert(matches[0] == matches[1]);
+
+        // Concurrent lookups, shared lock vs frozen
+        StringInterner pool;
+        for (const auto& name : names) {
+            pool.intern(name);
+        }
+        auto lookups = [&pool, &names, &picks]() {
+            std::vector<std::thread> threads;
+            for (size_t t = 0; t < 4; t++) {
+                threads.emplace_back([&pool, &names, &picks, t]() {
+                    size_t found = 0;
+                    for (size_t i = t; i < 4'000'000; i += 4) {
+                        found += pool.find(names[picks[i]]).valid();
+                    }
+                    assert(found == 1'000'000);
+                });
+            }
+            for (auto& t : threads) {
+                t.join();
+            }
+        };
+        start = std::chrono::high_resolution_clock::now();
+        lookups();
+        end = std::chrono::high_resolution_clock::now();
+        std::cout << "StringInterner shared lock lookups took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+        pool.freeze();
+        start = std::chrono::high_resolution_clock::now();
+        lookups();
+        end = std::chrono::high_resolution_clock::now();
+        std::cout << "StringInterner frozen lookups took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+    }
+
+    // Benchmark : 100MB document from 1KB fragments, written to /dev/null
+    {
+        size_t nFragments = 100 * 1024;
+        std::string fragmentText(1024, 'x');
+        for (size_t i = 0; i < fragmentText.size(); i += 64) {
+            fragmentText[i] = '\n';
+        }
+        int fd = open("/dev/null", O_WRONLY);
+        assert(fd >= 0);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        {
+            String doc;
+            for (size_t i = 0; i < nFragments; i++) {
+                doc += String{fragmentText.data(), fragmentText.size()};
+            }
+            [[maybe_unused]] ssize_t written = write(fd, doc.getCString(), doc.size());
+            assert(static_cast<size_t>(written) == doc.size());
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        std::cout << "String append + write took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+
+        start = std::chrono::high_resolution_clock::now();
+        Rope doc;
+        for (size_t i = 0; i < nFragments; i++) {
+            doc += Rope{String{fragmentText.data(), fragmentText.size()}};
+        }
+        auto iov = doc.iovecs();
+        size_t total = 0;
+        for (size_t i = 0; i < iov.size(); i += IOV_MAX) {
+            total += static_cast<size_t>(writev(fd, iov.data() + i, static_cast<int>(std::min<size_t>(IOV_MAX, iov.size() - i))));
+        }
+        assert(total == doc.size() && doc.size() == nFragments * 1024);
+        end = std::chrono::high_resolution_clock::now();
+        std::cout << "Rope append + writev took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+
+        // Slicing : 10k random 64KB windows
+        start = std::chrono::high_resolution_clock::now();
+        size_t sliced = 0;
+        std::mt19937 rng{5};
+        for (int i = 0; i < 10'000; i++) {
+            sliced += doc.substr(rng() % (doc.size() - 65536), 65536).size();
+        }
+        end = std::chrono::high_resolution_clock::now();
+        std::cout << "Rope 10k substr took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+
+        start = std::chrono::high_resolution_clock::now();
+        String flat = doc.flatten();
+        end = std::chrono::high_resolution_clock::now();
+        std::cout << "Rope flatten took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+        assert(flat.size() == doc.size() && sliced == 10'000 * size_t{65536});
+        close(fd);
+    }
+
+    // Benchmark : formatting 1M wire lines, StringBuilder vs snprintf vs ostringstream
+    {
+        size_t nLines = 1'000'000;
+        size_t total[3]{};
+        auto start = std::chrono::high_resolution_clock::now();
+        {
+            StringBuilder sb{256};
+            for (size_t i = 0; i < nLines; i++) {
+                sb.clear();
+                sb << "ts=" << 1700000000000ull + i << " id=" << static_cast<int64_t>(i) - 500000
+                   << " latency_ms=" << static_cast<double>(i % 1000) / 8 << " status=ok\n";
+                total[0] += sb.size();
+            }
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        std::cout << "StringBuilder took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+
+        start = std::chrono::high_resolution_clock::now();
+        {
+            char buf[256];
+            for (size_t i = 0; i < nLines; i++) {
+                int len = std::snprintf(buf, sizeof(buf), "ts=%llu id=%lld latency_ms=%.17g status=ok\n",
+                                        static_cast<unsigned long long>(1700000000000ull + i),
+                                        static_cast<long long>(i) - 500000, static_cast<double>(i % 1000) / 8);
+                total[1] += static_cast<size_t>(len);
+            }
+        }
+        end = std::chrono::high_resolution_clock::now();
+        std::cout << "snprintf took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+
+        start = std::chrono::high_resolution_clock::now();
+        {
+            std::ostringstream os;
+            os.precision(17);
+            for (size_t i = 0; i < nLines; i++) {
+                os.str("");
+                os << "ts=" << 1700000000000ull + i << " id=" << static_cast<int64_t>(i) - 500000
+                   << " latency_ms=" << static_cast<double>(i % 1000) / 8 << " status=ok\n";
+                total[2] += os.view().size();
+            }
+        }
+        end = std::chrono::high_resolution_clock::now();
+        std::cout << "std::ostringstream took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+        // %.17g / precision(17) print these exactly representable values shortest as well
+        assert(total[0] == total[1] && total[1] == total[2]);
+    }
+
+    // Benchmark : 10M short keys (21 chars) : inline for String, heap for std::string
+    {
+        size_t nKeys = 10'000'000;
+        char key[32];
+        auto start = std::chrono::high_resolution_clock::now();
+        {
+            std::unordered_map<String, int> map;
+            map.reserve(nKeys);
+            for (size_t i = 0; i < nKeys; i++) {
+                int len = std::snprintf(key, sizeof(key), "session:user:%08zu", i);
+                map.emplace(String{key, static_cast<size_t>(len)}, static_cast<int>(i));
+            }
+            assert(map.size() == nKeys && map.at(String{"session:user:00000042"}) == 42);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        std::cout << "String 10M key map took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+
+        start = std::chrono::high_resolution_clock::now();
+        {
+            std::unordered_map<std::string, int> map;
+            map.reserve(nKeys);
+            for (size_t i = 0; i < nKeys; i++) {
+                int len = std::snprintf(key, sizeof(key), "session:user:%08zu", i);
+                map.emplace(std::string{key, static_cast<size_t>(len)}, static_cast<int>(i));
+            }
+            assert(map.size() == nKeys && map.at("session:user:00000042") == 42);
+        }
+        end = std::chrono::high_resolution_clock::now();
+        std::cout << "std::string 10M key map took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+    }
+
 }
\ No newline at end of file
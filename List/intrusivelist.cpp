@@ -0,0 +1,356 @@
+#include<iostream>
+#include<cassert>
+#include<type_traits>
+#include<iterator>
+#include<utility>
+
+/*
+Intrusive doubly linked list : elements embed the prev / next links, so insert / erase never allocate
+and the list never owns, copies or moves elements
+
+An element type joins a list by deriving from a hook:
+    struct Order : IntrusiveListHook<> { ... };
+    IntrusiveList<Order> book;
+Different Tags let one object sit in several lists at once:
+    struct Timer : IntrusiveListHook<LinkMode::SafeUnlink, ByDeadline>, IntrusiveListHook<LinkMode::SafeUnlink, ByOwner> {};
+
+List is circular around a sentinel hook, so any linked hook can unlink itself in O(1) without knowing its list
+*/
+enum class LinkMode {
+  Normal,     // No bookkeeping, user ensures objects are unlinked before they die
+  SafeUnlink, // Hooks are reset on erase, insert of a linked object / destroy of a linked object asserts
+  AutoUnlink  // Like SafeUnlink but the hook unlinks itself on destruction, list size() becomes O(n)
+};
+
+struct DefaultHookTag {};
+
+template<LinkMode Mode = LinkMode::SafeUnlink, typename Tag = DefaultHookTag>
+class IntrusiveListHook {
+  IntrusiveListHook* m_prev{nullptr};
+  IntrusiveListHook* m_next{nullptr};
+
+  template<typename T, typename HookT>
+  friend class IntrusiveList;
+
+  void unlinkRaw() noexcept {
+    m_prev->m_next = m_next;
+    m_next->m_prev = m_prev;
+    if constexpr (Mode != LinkMode::Normal) {
+      m_prev = nullptr;
+      m_next = nullptr;
+    }
+  }
+public:
+  static constexpr LinkMode MODE = Mode;
+
+  IntrusiveListHook() = default;
+  // Copying an object does not copy its membership in lists
+  IntrusiveListHook(const IntrusiveListHook&) noexcept {}
+  IntrusiveListHook& operator=(const IntrusiveListHook&) noexcept {
+    return *this;
+  }
+  ~IntrusiveListHook() {
+    if constexpr (Mode == LinkMode::AutoUnlink) {
+      unlink();
+    }
+    else if constexpr (Mode == LinkMode::SafeUnlink) {
+      assert(!isLinked() && "object destroyed while still in an intrusive list");
+    }
+  }
+
+  // Only reliable in SafeUnlink / AutoUnlink modes
+  bool isLinked() const {
+    return m_next != nullptr;
+  }
+  // Removes object from whichever list holds it
+  void unlink() noexcept requires (Mode == LinkMode::AutoUnlink) {
+    if (isLinked()) {
+      unlinkRaw();
+    }
+  }
+};
+
+template<typename T, typename HookT = IntrusiveListHook<>>
+class IntrusiveList {
+  static_assert(std::is_base_of_v<HookT, T>, "T must derive from the list's hook type");
+  static constexpr bool TRACK_SIZE = (HookT::MODE != LinkMode::AutoUnlink);
+
+  HookT m_sentinel; // m_sentinel.m_next is head, m_sentinel.m_prev is tail
+  size_t m_size{};
+
+  static HookT* hookOf(T& val) {
+    return static_cast<HookT*>(&val);
+  }
+  static T* elemOf(HookT* hook) {
+    return static_cast<T*>(hook);
+  }
+  // Links hook before pos
+  void linkBefore(HookT* pos, HookT* hook) {
+    if constexpr (HookT::MODE != LinkMode::Normal) {
+      assert(!hook->isLinked() && "object is already in a list");
+    }
+    hook->m_next = pos;
+    hook->m_prev = pos->m_prev;
+    pos->m_prev->m_next = hook;
+    pos->m_prev = hook;
+    if constexpr (TRACK_SIZE) {
+      m_size++;
+    }
+  }
+  // Sentinel points to itself when empty
+  void resetSentinel() {
+    m_sentinel.m_next = &m_sentinel;
+    m_sentinel.m_prev = &m_sentinel;
+  }
+  void takeLinks(IntrusiveList& other) noexcept {
+    if (other.empty()) {
+      return;
+    }
+    // Relink first / last element to our sentinel
+    m_sentinel.m_next = other.m_sentinel.m_next;
+    m_sentinel.m_prev = other.m_sentinel.m_prev;
+    m_sentinel.m_next->m_prev = &m_sentinel;
+    m_sentinel.m_prev->m_next = &m_sentinel;
+    m_size = other.m_size;
+    other.resetSentinel();
+    other.m_size = 0;
+  }
+
+public:
+
+  template<bool IsConst>
+  class IteratorBase {
+    using PointerT = std::conditional_t<IsConst, const T*, T*>;
+    using referenceT = std::conditional_t<IsConst, const T&, T&>;
+
+    HookT* m_cur;
+    friend class IntrusiveList; // Allows IntrusiveList to access m_cur for erase/insert
+
+    public:
+    // required for <algorithm> functions
+    using iterator_category = std::bidirectional_iterator_tag;
+    using difference_type   = std::ptrdiff_t;
+    using value_type        = T;
+    using pointer           = PointerT;
+    using reference         = referenceT;
+
+    explicit IteratorBase(HookT* hook_) : m_cur{hook_} {}
+
+    template<bool OtherIsConstT, typename = std::enable_if_t<IsConst >= OtherIsConstT, void>>
+    IteratorBase (const IteratorBase<OtherIsConstT>& other) : m_cur{other.m_cur} {}
+
+    IteratorBase& operator++() {
+      m_cur = static_cast<HookT*>(m_cur->m_next);
+      return *this;
+    }
+    IteratorBase& operator--() {
+      m_cur = static_cast<HookT*>(m_cur->m_prev);
+      return *this;
+    }
+    reference operator*() const { // non const in reality : shallow constness
+      return *elemOf(m_cur);
+    }
+    pointer operator->() const {
+      return elemOf(m_cur);
+    }
+    friend bool operator==(const IteratorBase& f, const IteratorBase& s) {
+      return f.m_cur == s.m_cur;
+    }
+    friend bool operator!=(const IteratorBase& f, const IteratorBase& s) {
+      return f.m_cur != s.m_cur;
+    }
+  };
+  using Iterator = IteratorBase<false>;
+  using ConstIterator = IteratorBase<true>;
+
+  Iterator begin() {
+    return Iterator(static_cast<HookT*>(m_sentinel.m_next));
+  }
+  Iterator end() {
+    return Iterator(&m_sentinel);
+  }
+  ConstIterator begin() const {
+    return ConstIterator(static_cast<HookT*>(m_sentinel.m_next));
+  }
+  ConstIterator end() const {
+    return ConstIterator(const_cast<HookT*>(&m_sentinel));
+  }
+  // Iterator to an element known to be in this list : O(1)
+  Iterator iteratorTo(T& val) {
+    return Iterator(hookOf(val));
+  }
+
+  IntrusiveList() {
+    resetSentinel();
+  }
+
+  // Rule of 5 : elements can be in one list at a time, so no copy
+  IntrusiveList(const IntrusiveList&) = delete;
+  IntrusiveList& operator=(const IntrusiveList&) = delete;
+  IntrusiveList(IntrusiveList&& other) noexcept {
+    resetSentinel();
+    takeLinks(other);
+  }
+  IntrusiveList& operator=(IntrusiveList&& other) noexcept {
+    if (&other != this) {
+      clear();
+      takeLinks(other);
+    }
+    return *this;
+  }
+  ~IntrusiveList() {
+    clear();
+    // Sentinel is a hook too, mark it unlinked so its Dtor stays quiet
+    m_sentinel.m_next = nullptr;
+    m_sentinel.m_prev = nullptr;
+  }
+  // Rule of 5 end
+
+  void push_back(T& val) {
+    linkBefore(&m_sentinel, hookOf(val));
+  }
+  void push_front(T& val) {
+    linkBefore(static_cast<HookT*>(m_sentinel.m_next), hookOf(val));
+  }
+  // Links val before pos, returns iterator to val
+  Iterator insert(ConstIterator pos, T& val) {
+    linkBefore(pos.m_cur, hookOf(val));
+    return Iterator(hookOf(val));
+  }
+
+  // Unlinks element at it (element is not destroyed), returns iterator to next element
+  Iterator erase(ConstIterator it) {
+    HookT* hook = it.m_cur;
+    if (hook == &m_sentinel) return end();
+    HookT* next = static_cast<HookT*>(hook->m_next);
+    hook->unlinkRaw();
+    if constexpr (TRACK_SIZE) {
+      m_size--;
+    }
+    return Iterator(next);
+  }
+  // Unlinks val in O(1), val must be in this list
+  void remove(T& val) {
+    erase(iteratorTo(val));
+  }
+  void pop_front() {
+    erase(begin());
+  }
+  void pop_back() {
+    erase(Iterator(static_cast<HookT*>(m_sentinel.m_prev)));
+  }
+
+  T& front() {
+    return *elemOf(static_cast<HookT*>(m_sentinel.m_next));
+  }
+  T& back() {
+    return *elemOf(static_cast<HookT*>(m_sentinel.m_prev));
+  }
+
+  // empty
+  bool empty() const {
+    return m_sentinel.m_next == &m_sentinel;
+  }
+
+  // size : O(n) in AutoUnlink mode since elements can leave without telling the list
+  size_t size() const {
+    if constexpr (TRACK_SIZE) {
+      return m_size;
+    }
+    else {
+      return static_cast<size_t>(std::distance(begin(), end()));
+    }
+  }
+
+  // clear : unlinks every element, elements are not destroyed
+  void clear() {
+    if constexpr (HookT::MODE != LinkMode::Normal) {
+      // Reset hooks so elements know they are free
+      while (!empty()) {
+        static_cast<HookT*>(m_sentinel.m_next)->unlinkRaw();
+      }
+    }
+    resetSentinel();
+    m_size = 0;
+  }
+};
+
+int main() {
+  // Order book level : orders already exist, list only links them
+  {
+    struct Order : IntrusiveListHook<> {
+      int id;
+      int qty;
+      Order(int id_, int qty_) : id{id_}, qty{qty_} {}
+    };
+    Order a{1, 100}, b{2, 200}, c{3, 300};
+    IntrusiveList<Order> level;
+    level.push_back(a);
+    level.push_back(c);
+    level.insert(level.iteratorTo(c), b);
+    assert(level.size() == 3 && level.front().id == 1 && level.back().id == 3);
+    int total = 0;
+    for (const Order& o : level) {
+      total += o.qty;
+    }
+    assert(total == 600);
+    level.remove(b); // cancel in O(1)
+    assert(!b.isLinked() && level.size() == 2);
+    auto it = level.begin();
+    ++it;
+    assert(it->id == 3);
+    --it;
+    assert(it->id == 1);
+    level.pop_front();
+    assert(level.front().id == 3 && !a.isLinked());
+
+    IntrusiveList<Order> moved{std::move(level)};
+    assert(moved.size() == 1 && level.empty());
+    moved.clear();
+    assert(!c.isLinked());
+  }
+
+  // Timer in two lists, auto unlink on destruction
+  {
+    struct ByDeadline {};
+    struct ByOwner {};
+    using DeadlineHook = IntrusiveListHook<LinkMode::AutoUnlink, ByDeadline>;
+    using OwnerHook = IntrusiveListHook<LinkMode::AutoUnlink, ByOwner>;
+    struct Timer : DeadlineHook, OwnerHook {
+      int deadline;
+      explicit Timer(int deadline_) : deadline{deadline_} {}
+    };
+    IntrusiveList<Timer, DeadlineHook> byDeadline;
+    IntrusiveList<Timer, OwnerHook> byOwner;
+    Timer t1{10};
+    {
+      Timer t2{20};
+      byDeadline.push_back(t1);
+      byDeadline.push_back(t2);
+      byOwner.push_back(t2);
+      assert(byDeadline.size() == 2 && byOwner.size() == 1);
+    } // t2 leaves both lists on destruction
+    assert(byDeadline.size() == 1 && byOwner.empty());
+    assert(byDeadline.front().deadline == 10);
+    t1.DeadlineHook::unlink();
+    assert(byDeadline.empty());
+  }
+
+  // Normal mode : no bookkeeping
+  {
+    struct Node : IntrusiveListHook<LinkMode::Normal> {
+      int val;
+      explicit Node(int val_) : val{val_} {}
+    };
+    Node nodes[] = {Node{1}, Node{2}, Node{3}};
+    IntrusiveList<Node, IntrusiveListHook<LinkMode::Normal>> list;
+    for (auto& n : nodes) {
+      list.push_front(n);
+    }
+    assert(list.front().val == 3 && list.size() == 3);
+    list.erase(list.begin());
+    list.pop_back();
+    assert(list.size() == 1 && list.front().val == 2);
+    std::cout << list.front().val << '\n';
+  }
+}
@@ -1,6 +1,119 @@
 #include<iostream>
+#include<memory>
+#include<memory_resource>
+#include<chrono>
+#include<vector>
+#include<random>
+#include<cassert>
+#include<algorithm>
+#include<array>
+#include<cstddef>
+
+/*
+  Node pool for List, same idea as MemoryPool (MonotonicAllocator.cpp) : memory is carved out of slabs
+  of nReAllocSize slots and only returned to the OS on Dtor
+    - Free slots are kept in an intrusive free list (next pointer stored in the freed slot) instead of a vector
+    - Fresh slots are handed out in increasing address order, so nodes allocated one after another
+      (e.g. push_back loop) sit next to each other and traversal walks memory sequentially
+    - Slot size is fixed by the first allocation : one node type per pool
+  A pool can be owned by one list or shared by many (O(1) splice needs lists on the same pool)
+*/
+class NodePool {
+  struct FreeSlot {
+    FreeSlot* next;
+  };
+  std::vector<void*> m_toFree; // Stores slabs to delete on Dtor
+  FreeSlot* m_freeList{nullptr};
+  char* m_bump{nullptr}; // Next never used slot in newest slab
+  char* m_bumpEnd{nullptr};
+  size_t m_slotSize{0};
+  size_t m_slotAlign{0};
+  size_t m_reallocSize{0}; // Stores number of slots per slab
+
+  void addSlab() {
+    void* slab = ::operator new[](m_slotSize * m_reallocSize, std::align_val_t(m_slotAlign));
+    m_toFree.push_back(slab);
+    m_bump = reinterpret_cast<char*>(slab);
+    m_bumpEnd = m_bump + m_slotSize * m_reallocSize;
+  }
+public:
+  explicit NodePool(size_t nReAllocSize = 1<<12) : m_reallocSize{std::max<size_t>(nReAllocSize, 1)} {}
+
+  //Rule of 5 : Disable Copy / Move
+  ~NodePool() {
+    // User needs to ensure every node is deallocated (lists destroyed) before the pool
+    for (void* toFree : m_toFree) {
+      ::operator delete[](toFree, std::align_val_t(m_slotAlign));
+    }
+  }
+  NodePool(const NodePool&) = delete;
+  NodePool& operator=(const NodePool&) = delete;
+  // Rule of 5 end
+
+  void* allocate(size_t bytes, size_t align) {
+    if (m_slotSize == 0) {
+      m_slotAlign = std::max(align, alignof(FreeSlot));
+      m_slotSize = (std::max(bytes, sizeof(FreeSlot)) + m_slotAlign - 1) / m_slotAlign * m_slotAlign;
+    }
+    assert(bytes <= m_slotSize && align <= m_slotAlign);
+    // Reuse freed slot first : it is likely still in cache
+    if (m_freeList != nullptr) {
+      FreeSlot* slot = m_freeList;
+      m_freeList = slot->next;
+      return slot;
+    }
+    if (m_bump == m_bumpEnd) {
+      addSlab();
+    }
+    void* slot = m_bump;
+    m_bump += m_slotSize;
+    return slot;
+  }
+  void deallocate(void* ptr) noexcept {
+    FreeSlot* slot = reinterpret_cast<FreeSlot*>(ptr);
+    slot->next = m_freeList;
+    m_freeList = slot;
+  }
+};
+
+// Allocator handing out single objects from a NodePool, falls back to the heap for arrays
+template<typename T>
+struct PoolAllocator {
+  using value_type = T;
+  // Nodes can only be freed into the pool they came from, so the pool travels with them
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  NodePool* m_pool;
 
-template<typename ElemT>
+  explicit PoolAllocator(NodePool* pool) : m_pool{pool} {}
+  template<typename U>
+  PoolAllocator(const PoolAllocator<U>& other) : m_pool{other.m_pool} {}
+
+  T* allocate(size_t n) {
+    if (n != 1) {
+      return reinterpret_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+    }
+    return reinterpret_cast<T*>(m_pool->allocate(sizeof(T), alignof(T)));
+  }
+  void deallocate(T* ptr, size_t n) noexcept {
+    if (n != 1) {
+      ::operator delete(ptr, std::align_val_t(alignof(T)));
+      return;
+    }
+    m_pool->deallocate(ptr);
+  }
+  template<typename U>
+  friend bool operator==(const PoolAllocator& f, const PoolAllocator<U>& s) {
+    return f.m_pool == s.m_pool;
+  }
+};
+
+/*
+AllocT : nodes are allocated from AllocT rebound to Node, std::allocator keeps plain new / delete
+Allocator propagation on copy / move / swap follows the allocator's traits, same as std containers
+*/
+template<typename ElemT, typename AllocT = std::allocator<ElemT>>
 class List {
   
   struct Node {
@@ -18,17 +131,77 @@ class List {
     explicit Node(Node* prev_, Node* next_, ArgsT&&... args_) : val{std::forward<ArgsT>(args_)...},  prev{prev_}, next{next_} {}
   };
 
+  using NodeAllocT = typename std::allocator_traits<AllocT>::template rebind_alloc<Node>;
+  using NodeAllocTraits = std::allocator_traits<NodeAllocT>;
+  static constexpr bool IS_DEFAULT_ALLOC = std::is_same_v<AllocT, std::allocator<ElemT>>;
+
   Node* m_head{};
   Node* m_tail{};
   size_t m_size{};
+  [[no_unique_address]] NodeAllocT m_alloc;
+
+  template<typename... ArgsT>
+  Node* createNode(ArgsT&&... args) {
+    if constexpr (IS_DEFAULT_ALLOC) {
+      return new Node(std::forward<ArgsT>(args)...);
+    }
+    else {
+      Node* ptr = NodeAllocTraits::allocate(m_alloc, 1);
+      // Guarantee that memory is released if ctor throws
+      try {
+        new (ptr) Node(std::forward<ArgsT>(args)...);
+      }
+      catch(...) {
+        NodeAllocTraits::deallocate(m_alloc, ptr, 1);
+        throw;
+      }
+      return ptr;
+    }
+  }
 
   void release(Node* ptr) {
     ptr->next = nullptr;
     ptr->prev = nullptr;
-    delete ptr;
+    if constexpr (IS_DEFAULT_ALLOC) {
+      delete ptr;
+    }
+    else {
+      ptr->~Node();
+      NodeAllocTraits::deallocate(m_alloc, ptr, 1);
+    }
   }
 
-  void remove(Node* ptr) {
+  // Steals nodes of other, allocators must compare equal or have been propagated
+  void takeNodes(List& other) noexcept {
+    m_head = other.m_head;
+    m_tail = other.m_tail;
+    m_size = other.m_size;
+
+    other.m_head = nullptr;
+    other.m_tail = nullptr;
+    other.m_size = 0;
+  }
+
+  // Links chain [first, last] before pos (nullptr : at the end)
+  void linkBefore(Node* pos, Node* first, Node* last) {
+    Node* prev = (pos != nullptr ? pos->prev : m_tail);
+    first->prev = prev;
+    last->next = pos;
+    if (prev != nullptr) {
+      prev->next = first;
+    }
+    else {
+      m_head = first;
+    }
+    if (pos != nullptr) {
+      pos->prev = last;
+    }
+    else {
+      m_tail = last;
+    }
+  }
+  // Detaches ptr from the list without releasing it
+  void unlink(Node* ptr) {
     if (ptr->prev != nullptr) {
       ptr->prev->next = ptr->next;
     }
@@ -41,6 +214,46 @@ class List {
     else {
       m_tail = ptr->prev;
     }
+    ptr->prev = nullptr;
+    ptr->next = nullptr;
+  }
+  // Sort helpers : work on next pointers only
+  // Cuts chain after n nodes, returns the rest
+  static Node* cut(Node* head, size_t n) {
+    while (head != nullptr && --n != 0) {
+      head = head->next;
+    }
+    if (head == nullptr) {
+      return nullptr;
+    }
+    Node* rest = head->next;
+    head->next = nullptr;
+    return rest;
+  }
+  // Appends merge of sorted chains a and b at *tail, returns new tail slot
+  // Takes from b only if strictly smaller, which keeps the sort stable
+  template<typename CompareT>
+  static Node** merge(Node* a, Node* b, Node** tail, CompareT& comp) {
+    while (a != nullptr && b != nullptr) {
+      if (comp(b->val, a->val)) {
+        *tail = b;
+        b = b->next;
+      }
+      else {
+        *tail = a;
+        a = a->next;
+      }
+      tail = &((*tail)->next);
+    }
+    *tail = (a != nullptr ? a : b);
+    while (*tail != nullptr) {
+      tail = &((*tail)->next);
+    }
+    return tail;
+  }
+
+  void remove(Node* ptr) {
+    unlink(ptr);
     release(ptr);
   }
 
@@ -106,6 +319,7 @@ public:
   }
 
   List() = default;
+  explicit List(const AllocT& alloc) : m_alloc{alloc} {}
   List(std::initializer_list<ElemT> initlist_) { // read only list
     for (auto &x: initlist_) {
       push_back(x); // always copies
@@ -113,22 +327,23 @@ public:
   }
 
   // Rule of 5
-  List(const List& other) { // Copy Ctor
+  List(const List& other) : m_alloc{NodeAllocTraits::select_on_container_copy_construction(other.m_alloc)} { // Copy Ctor
     const Node* ptr = other.m_head;
     while (ptr != nullptr) {
       push_back(ptr->val);
       ptr = ptr->next;
     }
   }
-  List(List&& other) noexcept : m_head{other.m_head}, m_tail{other.m_tail}, m_size{other.m_size} { //Move Ctor
-    other.m_head = nullptr;
-    other.m_tail = nullptr;
-    other.m_size = 0;
+  List(List&& other) noexcept : m_alloc{std::move(other.m_alloc)} { //Move Ctor : allocator always moves with the nodes
+    takeNodes(other);
   }
   List& operator=(const List& other) { //copy assignment
     if (&other != this) {
       // clear this list first
       clear();
+      if constexpr (NodeAllocTraits::propagate_on_container_copy_assignment::value) {
+        m_alloc = other.m_alloc;
+      }
       // copy
       const Node* ptr = other.m_head;
       while (ptr != nullptr) {
@@ -142,17 +357,36 @@ public:
     if (&other != this) {
       // clear this list first
       clear();
-
-      m_head = other.m_head;
-      m_tail = other.m_tail;
-      m_size = other.m_size;
-
-      other.m_head = nullptr;
-      other.m_tail = nullptr;
-      other.m_size = 0;
+      if constexpr (NodeAllocTraits::propagate_on_container_move_assignment::value) {
+        m_alloc = std::move(other.m_alloc);
+        takeNodes(other);
+      }
+      else if (m_alloc == other.m_alloc) {
+        takeNodes(other);
+      }
+      else {
+        // Different arenas : nodes can't change hands, move elements one by one
+        for (auto& val : other) {
+          push_back(std::move(val));
+        }
+        other.clear();
+      }
     }
     return *this;
   }
+  // Swapping lists with unequal non propagating allocators is undefined, same as std containers
+  friend void swap(List& f, List& s) noexcept {
+    using std::swap;
+    if constexpr (NodeAllocTraits::propagate_on_container_swap::value) {
+      swap(f.m_alloc, s.m_alloc);
+    }
+    else {
+      assert(f.m_alloc == s.m_alloc);
+    }
+    swap(f.m_head, s.m_head);
+    swap(f.m_tail, s.m_tail);
+    swap(f.m_size, s.m_size);
+  }
   ~List() {
     clear();
   }
@@ -162,10 +396,10 @@ public:
   void push_back(const ElemT& val) {
     m_size++;
     if (m_head == nullptr) {
-      m_head = m_tail = new Node{val};
+      m_head = m_tail = createNode(val);
       return;
     }
-    m_tail->next = new Node{val, m_tail, nullptr};
+    m_tail->next = createNode(val, m_tail, nullptr);
     m_tail = m_tail->next;
   }
 
@@ -173,10 +407,10 @@ public:
   void push_back(ElemT&& val) {
     m_size++;
     if (m_head == nullptr) {
-      m_head = m_tail = new Node{std::move(val)};
+      m_head = m_tail = createNode(std::move(val));
       return;
     }
-    m_tail->next = new Node{std::move(val), m_tail, nullptr};
+    m_tail->next = createNode(std::move(val), m_tail, nullptr);
     m_tail = m_tail->next;
   }
 
@@ -184,10 +418,10 @@ public:
   void emplace_back(ArgsT&&... args_) {
     m_size++;
     if (m_head == nullptr) {
-        m_head = m_tail = new Node{nullptr, nullptr, std::forward<ArgsT>(args_)...};
+        m_head = m_tail = createNode(nullptr, nullptr, std::forward<ArgsT>(args_)...);
         return;
     }
-    m_tail->next = new Node{m_tail, nullptr, std::forward<ArgsT>(args_)...};
+    m_tail->next = createNode(m_tail, nullptr, std::forward<ArgsT>(args_)...);
     m_tail = m_tail->next;
   }
 
@@ -198,7 +432,7 @@ public:
       return Iterator(m_tail);
     }
     m_size++;
-    Node* newNode = new Node(val, curr->prev, curr);
+    Node* newNode = createNode(val, curr->prev, curr);
     if (curr->prev != nullptr) {
       curr->prev->next = newNode;
     } else {
@@ -224,10 +458,74 @@ public:
     Node* ptr = it.m_cur; 
     if (ptr == nullptr) return end();
     Node* nextNode = ptr->next;
+    m_size--;
     remove(ptr);
     return Iterator(nextNode);
   }
 
+  // Moves all nodes of other before pos in O(1), no node is allocated or copied
+  // Lists must use equal allocators (e.g. the same NodePool) since nodes change owner
+  void splice(ConstIterator pos, List& other) {
+    if (&other == this || other.m_head == nullptr) {
+      return;
+    }
+    assert(m_alloc == other.m_alloc);
+    Node* first = other.m_head;
+    Node* last = other.m_tail;
+    linkBefore(pos.m_cur, first, last);
+    m_size += other.m_size;
+    other.m_head = nullptr;
+    other.m_tail = nullptr;
+    other.m_size = 0;
+  }
+  // Moves node at it from other before pos in O(1)
+  void splice(ConstIterator pos, List& other, ConstIterator it) {
+    Node* node = it.m_cur;
+    if (node == nullptr || node == pos.m_cur) {
+      return;
+    }
+    assert(m_alloc == other.m_alloc);
+    other.unlink(node);
+    other.m_size--;
+    linkBefore(pos.m_cur, node, node);
+    m_size++;
+  }
+
+  // Stable in place merge sort : O(n log n), relinks nodes, never allocates or moves elements
+  template<typename CompareT = std::less<>>
+  void sort(CompareT comp = CompareT{}) {
+    if (m_size < 2) {
+      return;
+    }
+    // Bottom up : merge runs of width 1, 2, 4 ... using only next pointers
+    Node* head = m_head;
+    for (size_t width = 1; ; width <<= 1) {
+      Node* rest = head;
+      Node* mergedHead = nullptr;
+      Node** mergedTail = &mergedHead;
+      size_t nMerges = 0;
+      while (rest != nullptr) {
+        nMerges++;
+        Node* left = rest;
+        Node* right = cut(left, width);
+        rest = cut(right, width);
+        mergedTail = merge(left, right, mergedTail, comp);
+      }
+      head = mergedHead;
+      if (nMerges <= 1) {
+        break;
+      }
+    }
+    // Restore prev pointers and tail
+    m_head = head;
+    Node* prev = nullptr;
+    for (Node* cur = head; cur != nullptr; cur = cur->next) {
+      cur->prev = prev;
+      prev = cur;
+    }
+    m_tail = prev;
+  }
+
   // empty
   bool empty() const {
     return m_size == 0;
@@ -246,6 +544,11 @@ public:
       m_head = next;
     }
     m_tail = nullptr;
+    m_size = 0;
+  }
+
+  AllocT get_allocator() const {
+    return AllocT(m_alloc);
   }
 };
 
@@ -263,6 +566,142 @@ int main() {
     std::cout << x << ' ';
   }
   std::cout << '\n' << *std::max_element(r.begin(), r.end()) << '\n';
+
+  // Allocator propagation
+  {
+    using PmrList = List<std::string, std::pmr::polymorphic_allocator<std::string>>;
+    std::pmr::monotonic_buffer_resource arena1;
+    std::pmr::monotonic_buffer_resource arena2;
+    PmrList l1{&arena1};
+    PmrList l2{&arena2};
+    l1.push_back("a");
+    l1.emplace_back("b");
+    l2 = std::move(l1); // polymorphic_allocator does not propagate : element wise move
+    assert(l2.get_allocator().resource() == &arena2 && l2.size() == 2 && l1.empty());
+    PmrList l3{l2}; // copy construction goes to the default resource
+    assert(l3.get_allocator().resource() == std::pmr::get_default_resource());
+    PmrList l4{std::move(l2)}; // move construction always takes the allocator
+    assert(l4.get_allocator().resource() == &arena2 && *l4.begin() == "a");
+  }
+
+  // Node pool, splice, sort
+  {
+    NodePool pool{4};
+    using PoolList = List<int, PoolAllocator<int>>;
+    PoolList l1{PoolAllocator<int>{&pool}};
+    PoolList l2{PoolAllocator<int>{&pool}};
+    for (int x : {5, 3, 9, 1}) {
+      l1.push_back(x);
+    }
+    for (int x : {7, 3}) {
+      l2.push_back(x);
+    }
+    const int* nodeVal = &(*l2.begin());
+    l1.splice(l1.begin(), l2); // 7 3 5 3 9 1
+    assert(l1.size() == 6 && l2.empty());
+    assert(&(*l1.begin()) == nodeVal); // node was relinked, not copied
+    l2.splice(l2.end(), l1, l1.begin()); // l1 : 3 5 3 9 1, l2 : 7
+    assert(l1.size() == 5 && l2.size() == 1 && *l2.begin() == 7);
+    l1.sort();
+    int expected[] = {1, 3, 3, 5, 9};
+    int i = 0;
+    for (int x : l1) {
+      assert(x == expected[i++]);
+    }
+    // prev links restored : walk back from the last node
+    auto it = l1.begin();
+    for (size_t k = 1; k < l1.size(); k++) {
+      ++it;
+    }
+    assert(*it == 9);
+    for (i = 4; i > 0; i--, --it) {
+      assert(*it == expected[i]);
+    }
+    assert(it == l1.begin());
+    l1.erase(l1.begin());
+    assert(l1.size() == 4);
+
+    // Stable
+    List<std::pair<int, int>> pairs{{2, 0}, {1, 1}, {2, 2}, {1, 3}};
+    pairs.sort([](const auto& f, const auto& s) { return f.first < s.first; });
+    int order[] = {1, 3, 0, 2};
+    i = 0;
+    for (auto& p : pairs) {
+      assert(p.second == order[i++]);
+    }
+  }
+
+  // Benchmark : build, sort, iterate 10M nodes, heap vs node pool
+  {
+    size_t n = 10'000'000;
+    std::mt19937 rng{42};
+    std::vector<int> values(n);
+    for (auto& v : values) {
+      v = static_cast<int>(rng());
+    }
+    auto run = [&values](auto& list, const char* name) {
+      auto start = std::chrono::high_resolution_clock::now();
+      for (int v : values) {
+        list.push_back(v);
+      }
+      auto built = std::chrono::high_resolution_clock::now();
+      long long sum = 0;
+      for (int v : list) {
+        sum += v;
+      }
+      auto iterated = std::chrono::high_resolution_clock::now();
+      list.sort();
+      auto sorted = std::chrono::high_resolution_clock::now();
+      for (int v : list) {
+        sum -= v;
+      }
+      auto iteratedSorted = std::chrono::high_resolution_clock::now();
+      assert(sum == 0);
+      auto ns = [](auto f, auto s) { return std::chrono::duration_cast<std::chrono::nanoseconds>(s - f).count(); };
+      std::cout << name << " build took " << ns(start, built) << " nanoseconds! iterate took " << ns(built, iterated)
+                << " nanoseconds! sort took " << ns(iterated, sorted) << " nanoseconds! iterate sorted took "
+                << ns(sorted, iteratedSorted) << " nanoseconds!\n";
+    };
+    {
+      NodePool pool{1 << 16};
+      List<int, PoolAllocator<int>> poolList{PoolAllocator<int>{&pool}};
+      run(poolList, "List pool");
+    }
+    {
+      List<int> heapList;
+      run(heapList, "List heap");
+    }
+  }
+
+  // Benchmark : default heap vs per request arena
+  {
+    size_t nRequests = 100'000;
+    size_t sum = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t req = 0; req < nRequests; req++) {
+      List<int> list;
+      for (int i = 0; i < 100; i++) {
+        list.push_back(i);
+      }
+      sum += list.size();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::cout << "List default heap took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+
+    start = std::chrono::high_resolution_clock::now();
+    std::array<std::byte, 1 << 14> buffer;
+    for (size_t req = 0; req < nRequests; req++) {
+      std::pmr::monotonic_buffer_resource arena{buffer.data(), buffer.size()};
+      List<int, std::pmr::polymorphic_allocator<int>> list{&arena};
+      for (int i = 0; i < 100; i++) {
+        list.push_back(i);
+      }
+      sum += list.size();
+    }
+    end = std::chrono::high_resolution_clock::now();
+    std::cout << "List arena took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+    assert(sum == 2 * 100 * nRequests);
+  }
 }
 
 
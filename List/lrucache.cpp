@@ -0,0 +1,403 @@
+#include<iostream>
+#include<cassert>
+#include<unordered_map>
+#include<list>
+#include<vector>
+#include<functional>
+#include<optional>
+#include<mutex>
+#include<thread>
+#include<random>
+#include<cmath>
+#include<chrono>
+#include<memory>
+
+/*
+Bounded cache with O(1) get / put
+    - Hash index : std::unordered_map<K, Entry>, nodes are stable so entries are linked in place
+    - Recency order : intrusive circular list through the entries (same sentinel design as IntrusiveList),
+      no separate list node per entry as with std::list + std::unordered_map
+    - Lru   : a hit relinks the entry to the front, the back is evicted
+    - Clock : a hit only sets a reference bit, a hand sweeps the ring and evicts the first entry
+              without the bit (second chance), so the hit path never writes the links
+    - onEvict(key, value) is called for every entry pushed out by put
+*/
+enum class EvictionPolicy {
+  Lru,
+  Clock
+};
+
+template<typename K, typename V, EvictionPolicy Policy = EvictionPolicy::Lru, typename HashT = std::hash<K>>
+class LruCache {
+public:
+  using EvictCallbackT = std::function<void(const K&, V&)>;
+private:
+  struct Link {
+    Link* prev{};
+    Link* next{};
+  };
+  struct Entry : Link {
+    V value;
+    const K* key{}; // Points to key in the map node
+    bool referenced{false}; // Clock only
+
+    template<typename U>
+    explicit Entry(U&& value_) : value{std::forward<U>(value_)} {}
+  };
+
+  std::unordered_map<K, Entry, HashT> m_index;
+  Link m_sentinel; // Lru : next is most recent, prev is least recent
+  Link* m_hand{&m_sentinel}; // Clock : next entry to inspect
+  size_t m_capacity;
+  EvictCallbackT m_onEvict;
+
+  static void unlink(Link* link) {
+    link->prev->next = link->next;
+    link->next->prev = link->prev;
+  }
+  static void linkBefore(Link* pos, Link* link) {
+    link->next = pos;
+    link->prev = pos->prev;
+    pos->prev->next = link;
+    pos->prev = link;
+  }
+  // Skips sentinel while moving the clock hand
+  Link* advance(Link* link) {
+    link = link->next;
+    return (link == &m_sentinel ? link->next : link);
+  }
+  Entry* victim() {
+    if constexpr (Policy == EvictionPolicy::Lru) {
+      return static_cast<Entry*>(m_sentinel.prev);
+    }
+    else {
+      Link* hand = (m_hand == &m_sentinel ? advance(m_hand) : m_hand);
+      // Second chance : clear bits until an unreferenced entry comes up, at most one full sweep
+      while (static_cast<Entry*>(hand)->referenced) {
+        static_cast<Entry*>(hand)->referenced = false;
+        hand = advance(hand);
+      }
+      m_hand = hand;
+      return static_cast<Entry*>(hand);
+    }
+  }
+  void evict() {
+    Entry* entry = victim();
+    if constexpr (Policy == EvictionPolicy::Clock) {
+      m_hand = advance(entry);
+      if (m_hand == entry) {
+        m_hand = &m_sentinel;
+      }
+    }
+    unlink(entry);
+    if (m_onEvict) {
+      m_onEvict(*entry->key, entry->value);
+    }
+    m_index.erase(*entry->key);
+  }
+  void touch(Entry* entry) {
+    if constexpr (Policy == EvictionPolicy::Lru) {
+      if (m_sentinel.next != entry) {
+        unlink(entry);
+        linkBefore(m_sentinel.next, entry);
+      }
+    }
+    else {
+      entry->referenced = true;
+    }
+  }
+  // Lru : new entries go to the front, Clock : just behind the hand so they are inspected last
+  void linkNew(Entry* entry) {
+    if constexpr (Policy == EvictionPolicy::Lru) {
+      linkBefore(m_sentinel.next, entry);
+    }
+    else {
+      linkBefore(m_hand, entry);
+    }
+  }
+
+public:
+  explicit LruCache(size_t capacity, EvictCallbackT onEvict = {}) :
+      m_capacity{std::max<size_t>(capacity, 1)}, m_onEvict{std::move(onEvict)} {
+    m_sentinel.next = &m_sentinel;
+    m_sentinel.prev = &m_sentinel;
+    m_index.reserve(m_capacity);
+  }
+
+  // Entries point to the sentinel and into the map : disable copy / move
+  LruCache(const LruCache&) = delete;
+  LruCache& operator=(const LruCache&) = delete;
+
+  // Returns nullptr on miss, pointer is valid until the next put
+  V* get(const K& key) {
+    auto it = m_index.find(key);
+    if (it == m_index.end()) {
+      return nullptr;
+    }
+    touch(&it->second);
+    return &it->second.value;
+  }
+
+  template<typename U>
+  void put(const K& key, U&& value) {
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+      it->second.value = std::forward<U>(value);
+      touch(&it->second);
+      return;
+    }
+    if (m_index.size() == m_capacity) {
+      evict();
+    }
+    auto [pos, inserted] = m_index.try_emplace(key, std::forward<U>(value));
+    Entry* entry = &pos->second;
+    entry->key = &pos->first;
+    linkNew(entry);
+  }
+
+  bool erase(const K& key) {
+    auto it = m_index.find(key);
+    if (it == m_index.end()) {
+      return false;
+    }
+    Entry* entry = &it->second;
+    if (m_hand == entry) {
+      m_hand = advance(entry);
+      if (m_hand == entry) {
+        m_hand = &m_sentinel;
+      }
+    }
+    unlink(entry);
+    m_index.erase(it);
+    return true;
+  }
+
+  bool contains(const K& key) const {
+    return m_index.find(key) != m_index.end();
+  }
+  size_t size() const {
+    return m_index.size();
+  }
+  size_t capacity() const {
+    return m_capacity;
+  }
+};
+
+/*
+Concurrent cache : keys are hashed to N independent shards, each with its own mutex and LruCache
+Threads touching different shards never contend, get returns a copy since entries can be evicted
+by another thread as soon as the lock is dropped
+*/
+template<typename K, typename V, EvictionPolicy Policy = EvictionPolicy::Lru, size_t N = 16, typename HashT = std::hash<K>>
+class ShardedLruCache {
+  static_assert(N > 0 && !(N & (N-1)), "Number of shards should be a power of two");
+  using CacheT = LruCache<K, V, Policy, HashT>;
+
+  struct Shard {
+    alignas(64) std::mutex lock; // align with 64 to avoid false sharing between shards
+    CacheT cache;
+    Shard(size_t capacity, typename CacheT::EvictCallbackT onEvict) : cache{capacity, std::move(onEvict)} {}
+  };
+  std::vector<std::unique_ptr<Shard>> m_shards;
+  HashT m_hash;
+
+  Shard& shardFor(const K& key) {
+    // Upper hash bits pick the shard so the lower bits stay useful for the shard's own table
+    size_t h = m_hash(key) * 0x9E3779B97F4A7C15ull;
+    return *m_shards[(h >> 32) & (N - 1)];
+  }
+public:
+  // onEvict is called under the shard lock
+  explicit ShardedLruCache(size_t capacity, typename CacheT::EvictCallbackT onEvict = {}) {
+    size_t perShard = std::max<size_t>(capacity / N, 1);
+    for (size_t i = 0; i < N; i++) {
+      m_shards.push_back(std::make_unique<Shard>(perShard, onEvict));
+    }
+  }
+
+  std::optional<V> get(const K& key) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> guard{shard.lock};
+    V* value = shard.cache.get(key);
+    return value ? std::optional<V>{*value} : std::nullopt;
+  }
+  template<typename U>
+  void put(const K& key, U&& value) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> guard{shard.lock};
+    shard.cache.put(key, std::forward<U>(value));
+  }
+  bool erase(const K& key) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> guard{shard.lock};
+    return shard.cache.erase(key);
+  }
+};
+
+// Ad hoc LRU we replace : std::list of keys + map to list iterators
+template<typename K, typename V>
+class StdListLru {
+  std::list<std::pair<K, V>> m_order;
+  std::unordered_map<K, typename std::list<std::pair<K, V>>::iterator> m_index;
+  size_t m_capacity;
+public:
+  explicit StdListLru(size_t capacity) : m_capacity{capacity} {}
+  V* get(const K& key) {
+    auto it = m_index.find(key);
+    if (it == m_index.end()) {
+      return nullptr;
+    }
+    m_order.splice(m_order.begin(), m_order, it->second);
+    return &it->second->second;
+  }
+  void put(const K& key, const V& value) {
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+      it->second->second = value;
+      m_order.splice(m_order.begin(), m_order, it->second);
+      return;
+    }
+    if (m_index.size() == m_capacity) {
+      m_index.erase(m_order.back().first);
+      m_order.pop_back();
+    }
+    m_order.emplace_front(key, value);
+    m_index[key] = m_order.begin();
+  }
+};
+
+// Zipf distributed keys in [0, n) with skew s, sampled by binary search over the CDF
+std::vector<int> zipfKeys(size_t n, double s, size_t count, unsigned seed) {
+  std::vector<double> cdf(n);
+  double sum = 0;
+  for (size_t i = 0; i < n; i++) {
+    sum += 1.0 / std::pow(static_cast<double>(i + 1), s);
+    cdf[i] = sum;
+  }
+  std::mt19937 rng{seed};
+  std::uniform_real_distribution<double> dist{0, sum};
+  std::vector<int> keys(count);
+  for (auto& k : keys) {
+    k = static_cast<int>(std::lower_bound(cdf.begin(), cdf.end(), dist(rng)) - cdf.begin());
+  }
+  return keys;
+}
+
+// Get, put on miss : returns nanoseconds per operation and hit ratio
+template<typename CacheT>
+std::pair<double, double> benchmarkCache(CacheT& cache, const std::vector<int>& keys) {
+  size_t hits = 0;
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int key : keys) {
+    if (cache.get(key)) {
+      hits++;
+    }
+    else {
+      cache.put(key, key);
+    }
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+  return {ns / keys.size(), static_cast<double>(hits) / keys.size()};
+}
+
+int main() {
+  // Lru
+  {
+    std::vector<int> evicted;
+    LruCache<int, std::string> cache{2, [&evicted](const int& key, std::string&) { evicted.push_back(key); }};
+    cache.put(1, "one");
+    cache.put(2, "two");
+    assert(*cache.get(1) == "one"); // 1 is most recent
+    cache.put(3, "three"); // evicts 2
+    assert(evicted == std::vector<int>{2});
+    assert(cache.get(2) == nullptr && cache.contains(1) && cache.contains(3));
+    cache.put(1, "uno"); // update refreshes 1
+    cache.put(4, "four"); // evicts 3
+    assert(evicted.back() == 3 && *cache.get(1) == "uno");
+    assert(cache.erase(4) && !cache.erase(4) && cache.size() == 1);
+  }
+
+  // Clock
+  {
+    std::vector<int> evicted;
+    LruCache<int, int, EvictionPolicy::Clock> cache{3, [&evicted](const int& key, int&) { evicted.push_back(key); }};
+    cache.put(1, 1);
+    cache.put(2, 2);
+    cache.put(3, 3);
+    cache.get(1); // second chance for 1
+    cache.put(4, 4); // 1 is skipped, 2 is evicted
+    assert(evicted == std::vector<int>{2});
+    cache.put(5, 5); // 3 is evicted
+    assert(evicted.back() == 3);
+    cache.put(6, 6); // 1 lost its bit on the first sweep
+    assert(evicted.back() == 1);
+    assert(cache.contains(4) && cache.contains(5) && cache.contains(6));
+    cache.erase(4);
+    cache.erase(5);
+    cache.erase(6);
+    cache.put(7, 7);
+    assert(*cache.get(7) == 7 && cache.size() == 1);
+  }
+
+  // Sharded
+  {
+    ShardedLruCache<int, int> cache{1 << 10};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+      threads.emplace_back([&cache, t]() {
+        for (int i = 0; i < 10000; i++) {
+          int key = (i * 7 + t) % 2000;
+          auto value = cache.get(key);
+          assert(!value || *value == key);
+          if (!value) {
+            cache.put(key, key);
+          }
+        }
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+  }
+
+  // Benchmark : hit path under Zipf(0.99) access, cache holds 10% of keys
+  {
+    size_t nKeys = 1'000'000;
+    auto keys = zipfKeys(nKeys, 0.99, 10'000'000, 42);
+    size_t capacity = nKeys / 10;
+
+    StdListLru<int, int> adhoc{capacity};
+    auto [adhocNs, adhocHits] = benchmarkCache(adhoc, keys);
+    std::cout << "std::list + unordered_map : " << adhocNs << " ns/op, hit ratio " << adhocHits << '\n';
+
+    LruCache<int, int> lru{capacity};
+    auto [lruNs, lruHits] = benchmarkCache(lru, keys);
+    std::cout << "LruCache lru : " << lruNs << " ns/op, hit ratio " << lruHits << '\n';
+
+    LruCache<int, int, EvictionPolicy::Clock> clock{capacity};
+    auto [clockNs, clockHits] = benchmarkCache(clock, keys);
+    std::cout << "LruCache clock : " << clockNs << " ns/op, hit ratio " << clockHits << '\n';
+
+    size_t nThreads = 4;
+    ShardedLruCache<int, int, EvictionPolicy::Clock> sharded{capacity};
+    std::vector<std::thread> threads;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t t = 0; t < nThreads; t++) {
+      threads.emplace_back([&sharded, &keys, t, nThreads]() {
+        for (size_t i = t; i < keys.size(); i += nThreads) {
+          if (!sharded.get(keys[i])) {
+            sharded.put(keys[i], keys[i]);
+          }
+        }
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::cout << "ShardedLruCache clock, " << nThreads << " threads : "
+              << static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()) / keys.size()
+              << " ns/op\n";
+  }
+}
@@ -0,0 +1,606 @@
+#include<iostream>
+#include<algorithm>
+#include<cassert>
+#include<chrono>
+#include<list>
+#include<vector>
+#include<string>
+#include<stdexcept>
+#include<random>
+
+/*
+Unrolled linked list : every node stores up to K elements contiguously
+    - Iteration touches one node header per K elements instead of one heap node per element
+    - Insert at an iterator shifts at most K elements, a full node is split in two halves
+    - Erase at an iterator shifts at most K elements, a node that drops below half full merges with a neighbour
+      (next, or prev for the tail) if both fit in one node, otherwise borrows from it until both are half full
+      : every node but the tail stays at least half full, empty nodes are freed
+Same iterator interface as List (list.cpp)
+
+Iterators are invalidated by insert / erase in the same node and by split / merge
+*/
+template<typename ElemT, size_t K = 16>
+class UnrolledList {
+  static_assert(K >= 2, "UnrolledList needs at least two elements per node");
+  static constexpr size_t MIN_FILL = std::max<size_t>(1, K / 2);
+
+  struct Node {
+    Node* prev{};
+    Node* next{};
+    size_t count{};
+    alignas(ElemT) unsigned char storage[K * sizeof(ElemT)];
+
+    ElemT* at(size_t i) {
+      return reinterpret_cast<ElemT*>(storage) + i;
+    }
+    // Opens a hole at i by shifting [i, count) right by one, hole holds a moved-from element unless i == count
+    // Returns true if the hole is constructed (assign into it), false if raw (construct into it)
+    bool openHole(size_t i) {
+      if (i == count) {
+        return false;
+      }
+      new (at(count)) ElemT(std::move(*at(count - 1)));
+      std::move_backward(at(i), at(count - 1), at(count));
+      return true;
+    }
+    // Removes element at i by shifting [i+1, count) left by one
+    void close(size_t i) {
+      std::move(at(i + 1), at(count), at(i));
+      at(count - 1)->~ElemT();
+      count--;
+    }
+    ~Node() {
+      for (size_t i = 0; i < count; i++) {
+        at(i)->~ElemT();
+      }
+    }
+  };
+
+  Node* m_head{};
+  Node* m_tail{};
+  size_t m_size{};
+
+  // Links a new empty node after pos (nullptr : at the front)
+  Node* createNodeAfter(Node* pos) {
+    Node* node = new Node{};
+    node->prev = pos;
+    node->next = (pos != nullptr ? pos->next : m_head);
+    if (node->next != nullptr) {
+      node->next->prev = node;
+    }
+    else {
+      m_tail = node;
+    }
+    if (pos != nullptr) {
+      pos->next = node;
+    }
+    else {
+      m_head = node;
+    }
+    return node;
+  }
+  void release(Node* node) {
+    if (node->prev != nullptr) {
+      node->prev->next = node->next;
+    }
+    else {
+      m_head = node->next;
+    }
+    if (node->next != nullptr) {
+      node->next->prev = node->prev;
+    }
+    else {
+      m_tail = node->prev;
+    }
+    delete node;
+  }
+  // Moves upper half of a full node into a new node after it
+  Node* split(Node* node) {
+    Node* right = createNodeAfter(node);
+    size_t half = K / 2;
+    for (size_t i = half; i < K; i++) {
+      new (right->at(i - half)) ElemT(std::move(*node->at(i)));
+      node->at(i)->~ElemT();
+    }
+    right->count = K - half;
+    node->count = half;
+    return right;
+  }
+  // Merges next node into node if both fit
+  void mergeNext(Node* node) {
+    Node* next = node->next;
+    if (next == nullptr || node->count + next->count > K) {
+      return;
+    }
+    for (size_t i = 0; i < next->count; i++) {
+      new (node->at(node->count + i)) ElemT(std::move(*next->at(i)));
+    }
+    node->count += next->count;
+    release(next);
+  }
+  // Moves the first n elements of node->next to the end of node
+  void borrowFromNext(Node* node, size_t n) {
+    Node* next = node->next;
+    for (size_t i = 0; i < n; i++) {
+      new (node->at(node->count + i)) ElemT(std::move(*next->at(i)));
+    }
+    std::move(next->at(n), next->at(next->count), next->at(0));
+    for (size_t i = next->count - n; i < next->count; i++) {
+      next->at(i)->~ElemT();
+    }
+    node->count += n;
+    next->count -= n;
+  }
+  // Moves the last n elements of node->prev to the front of node
+  void borrowFromPrev(Node* node, size_t n) {
+    Node* prev = node->prev;
+    // Shift right by n : slots past count are raw, the rest hold live elements
+    for (size_t i = node->count; i-- > 0;) {
+      if (i + n >= node->count) {
+        new (node->at(i + n)) ElemT(std::move(*node->at(i)));
+      }
+      else {
+        *node->at(i + n) = std::move(*node->at(i));
+      }
+    }
+    for (size_t i = 0; i < n; i++) {
+      ElemT& src = *prev->at(prev->count - n + i);
+      if (i < node->count) {
+        *node->at(i) = std::move(src);
+      }
+      else {
+        new (node->at(i)) ElemT(std::move(src));
+      }
+      src.~ElemT();
+    }
+    node->count += n;
+    prev->count -= n;
+  }
+  // Refills a node that dropped below MIN_FILL, idx follows the element it pointed to, returns its node
+  Node* rebalance(Node* node, size_t& idx) {
+    if (Node* next = node->next) {
+      if (node->count + next->count <= K) {
+        mergeNext(node);
+      }
+      else {
+        borrowFromNext(node, (next->count - node->count) / 2);
+      }
+    }
+    else if (Node* prev = node->prev) {
+      if (prev->count + node->count <= K) {
+        idx += prev->count;
+        mergeNext(prev);
+        return prev;
+      }
+      size_t n = (prev->count - node->count) / 2;
+      borrowFromPrev(node, n);
+      idx += n;
+    }
+    return node;
+  }
+
+  // Moves an already built value into position i, node must not be full
+  void placeAt(Node* node, size_t i, ElemT&& val) {
+    if (node->openHole(i)) {
+      *node->at(i) = std::move(val);
+    }
+    else {
+      new (node->at(i)) ElemT(std::move(val));
+    }
+    node->count++;
+    m_size++;
+  }
+  template<typename... ArgsT>
+  void emplaceAt(Node* node, size_t i, ArgsT&&... args) {
+    if (i == node->count) {
+      // Nothing to shift : construct in place, a throw leaves the node's elements as they were
+      new (node->at(i)) ElemT(std::forward<ArgsT>(args)...);
+      node->count++;
+      m_size++;
+      return;
+    }
+    // Build before shifting : args may refer into the node and a throwing Ctor must not leave a hole
+    placeAt(node, i, ElemT(std::forward<ArgsT>(args)...));
+  }
+
+public:
+
+  template<bool IsConst>
+  class IteratorBase {
+    using PointerT = std::conditional_t<IsConst, const ElemT*, ElemT*>;
+    using referenceT = std::conditional_t<IsConst, const ElemT&, ElemT&>;
+
+    Node* m_cur;
+    size_t m_idx;
+    friend class UnrolledList; // Allows UnrolledList to access m_cur for erase/insert
+
+    public:
+    // required for <algorithm> functions
+    using iterator_category = std::forward_iterator_tag;
+    using difference_type   = std::ptrdiff_t;
+    using value_type        = ElemT;
+    using pointer           = PointerT;
+    using reference         = referenceT;
+
+    explicit IteratorBase(Node* node_, size_t idx_ = 0) : m_cur{node_}, m_idx{idx_} {}
+
+    template<bool OtherIsConstT, typename = std::enable_if_t<IsConst >= OtherIsConstT, void>>
+    IteratorBase (const IteratorBase<OtherIsConstT>& other) : m_cur{other.m_cur}, m_idx{other.m_idx} {}
+
+    IteratorBase& operator++() {
+      if (++m_idx == m_cur->count) {
+        m_cur = m_cur->next;
+        m_idx = 0;
+      }
+      return *this;
+    }
+    IteratorBase& operator--() {
+      if (m_idx == 0) {
+        m_cur = m_cur->prev;
+        m_idx = m_cur->count;
+      }
+      m_idx--;
+      return *this;
+    }
+    reference operator*() const { // non const in reality : shallow constness
+      return *m_cur->at(m_idx);
+    }
+    pointer operator->() const {
+      return m_cur->at(m_idx);
+    }
+    friend bool operator==(const IteratorBase& f, const IteratorBase& s) {
+      return f.m_cur == s.m_cur && f.m_idx == s.m_idx;
+    }
+    friend bool operator!=(const IteratorBase& f, const IteratorBase& s) {
+      return !(f == s);
+    }
+  };
+  using Iterator = IteratorBase<false>;
+  using ConstIterator = IteratorBase<true>;
+
+  Iterator begin() {
+    return Iterator(m_head);
+  }
+  Iterator end() {
+    return Iterator(nullptr);
+  }
+  ConstIterator begin() const {
+    return ConstIterator(m_head);
+  }
+  ConstIterator end() const {
+    return ConstIterator(nullptr);
+  }
+
+  UnrolledList() = default;
+  UnrolledList(std::initializer_list<ElemT> initlist_) { // read only list
+    for (auto &x: initlist_) {
+      push_back(x); // always copies
+    }
+  }
+
+  // Rule of 5
+  UnrolledList(const UnrolledList& other) { // Copy Ctor
+    for (const auto& val : other) {
+      push_back(val);
+    }
+  }
+  UnrolledList(UnrolledList&& other) noexcept : m_head{other.m_head}, m_tail{other.m_tail}, m_size{other.m_size} { //Move Ctor
+    other.m_head = nullptr;
+    other.m_tail = nullptr;
+    other.m_size = 0;
+  }
+  UnrolledList& operator=(const UnrolledList& other) { //copy assignment
+    if (&other != this) {
+      clear();
+      for (const auto& val : other) {
+        push_back(val);
+      }
+    }
+    return *this;
+  }
+  UnrolledList& operator=(UnrolledList&& other) noexcept { // Move assignemnt
+    if (&other != this) {
+      clear();
+      m_head = other.m_head;
+      m_tail = other.m_tail;
+      m_size = other.m_size;
+      other.m_head = nullptr;
+      other.m_tail = nullptr;
+      other.m_size = 0;
+    }
+    return *this;
+  }
+  ~UnrolledList() {
+    clear();
+  }
+  // Rule of 5 end
+
+  void push_back(const ElemT& val) {
+    emplace_back(val);
+  }
+  void push_back(ElemT&& val) {
+    emplace_back(std::move(val));
+  }
+  template<typename... ArgsT>
+  void emplace_back(ArgsT&&... args_) {
+    if (m_tail != nullptr && m_tail->count != K) {
+      emplaceAt(m_tail, m_tail->count, std::forward<ArgsT>(args_)...);
+      return;
+    }
+    // Iterators never step over an empty node : drop the new one if the Ctor throws
+    Node* node = createNodeAfter(m_tail);
+    try {
+      emplaceAt(node, 0, std::forward<ArgsT>(args_)...);
+    }
+    catch (...) {
+      release(node);
+      throw;
+    }
+  }
+
+  // Inserts before pos, returns iterator to inserted element
+  Iterator insert(ConstIterator pos, const ElemT& val) {
+    Node* node = pos.m_cur;
+    size_t idx = pos.m_idx;
+    if (node == nullptr) {
+      push_back(val);
+      return Iterator(m_tail, m_tail->count - 1);
+    }
+    // Copy first : val may be an element of this list that split / openHole moves from
+    ElemT copy(val);
+    if (node->count == K) {
+      Node* right = split(node);
+      if (idx > node->count) {
+        idx -= node->count;
+        node = right;
+      }
+    }
+    placeAt(node, idx, std::move(copy));
+    return Iterator(node, idx);
+  }
+
+  // Erases element at it, returns iterator to next element
+  Iterator erase(ConstIterator it) {
+    Node* node = it.m_cur;
+    size_t idx = it.m_idx;
+    if (node == nullptr) return end();
+    node->close(idx);
+    m_size--;
+    if (node->count == 0) {
+      Node* next = node->next;
+      release(node);
+      return Iterator(next);
+    }
+    if (node->count < MIN_FILL) {
+      node = rebalance(node, idx);
+    }
+    if (idx == node->count) {
+      return Iterator(node->next);
+    }
+    return Iterator(node, idx);
+  }
+
+  // erase first element equal to val
+  void erase(const ElemT& val) {
+    for (auto it = begin(); it != end(); ++it) {
+      if (*it == val) {
+        erase(it);
+        return;
+      }
+    }
+  }
+
+  // empty
+  bool empty() const {
+    return m_size == 0;
+  }
+
+  // size
+  size_t size() const {
+    return m_size;
+  }
+  size_t nodeCount() const {
+    size_t count = 0;
+    for (Node* node = m_head; node != nullptr; node = node->next) {
+      count++;
+    }
+    return count;
+  }
+
+  // clear
+  void clear() {
+    while(m_head != nullptr) {
+      auto next = m_head->next;
+      delete m_head;
+      m_head = next;
+    }
+    m_tail = nullptr;
+    m_size = 0;
+  }
+};
+
+template<typename ListT>
+long long benchmarkIterate(const ListT& list, long long& sum) {
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int rep = 0; rep < 10; rep++) {
+    for (int x : list) {
+      sum += x;
+    }
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+// Inserts nInserts elements in the middle, iterator is found once and kept
+template<typename ListT>
+long long benchmarkMidInsert(ListT& list, size_t nInserts) {
+  auto start = std::chrono::high_resolution_clock::now();
+  auto it = list.begin();
+  std::advance(it, list.size() / 2);
+  for (size_t i = 0; i < nInserts; i++) {
+    it = list.insert(it, static_cast<int>(i));
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+int main() {
+  {
+    UnrolledList<int, 4> l;
+    for (int i = 0; i < 10; i++) {
+      l.push_back(i);
+    }
+    assert(l.size() == 10);
+    // insert into full node : split
+    auto it = l.begin();
+    ++it;
+    it = l.insert(it, 100);
+    assert(*it == 100);
+    std::vector<int> expected{0, 100, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    assert(std::equal(l.begin(), l.end(), expected.begin(), expected.end()));
+    // erase : shifts and merges
+    it = l.erase(it);
+    assert(*it == 1);
+    for (int i = 0; i < 5; i++) {
+      it = l.erase(it);
+    }
+    assert(*it == 6);
+    expected = {0, 6, 7, 8, 9};
+    assert(std::equal(l.begin(), l.end(), expected.begin(), expected.end()));
+    l.insert(l.end(), 10);
+    l.erase(0);
+    expected = {6, 7, 8, 9, 10};
+    assert(std::equal(l.begin(), l.end(), expected.begin(), expected.end()));
+    auto back = l.begin();
+    std::advance(back, 4);
+    --back;
+    assert(*back == 9);
+    while (!l.empty()) {
+      l.erase(l.begin());
+    }
+    assert(l.begin() == l.end());
+  }
+  {
+    UnrolledList<std::string, 3> s{"a", "b", "c", "d"};
+    UnrolledList<std::string, 3> copy{s};
+    copy.insert(copy.begin(), "z");
+    assert(*copy.begin() == "z" && *s.begin() == "a" && copy.size() == 5);
+    UnrolledList<std::string, 3> moved{std::move(copy)};
+    assert(moved.size() == 5 && copy.empty());
+    std::cout << *std::max_element(moved.begin(), moved.end()) << '\n';
+  }
+  {
+    // Inserting an element of the list itself, into a full node and into a node with room
+    std::string longWord(40, 'w');
+    UnrolledList<std::string, 8> l;
+    for (int i = 0; i < 8; i++) {
+      l.push_back(longWord + std::to_string(i));
+    }
+    l.insert(l.begin(), *l.begin());
+    assert(l.size() == 9 && *l.begin() == longWord + "0" && *std::next(l.begin()) == longWord + "0");
+    auto last = std::next(l.begin(), 3);
+    l.insert(l.begin(), *last);
+    assert(*l.begin() == longWord + "2" && *std::next(l.begin(), 4) == longWord + "2");
+  }
+  {
+    // A throwing copy leaves the node unchanged
+    struct ThrowOnCopy {
+      int val;
+      ThrowOnCopy(int v) : val{v} {}
+      ThrowOnCopy(const ThrowOnCopy& other) : val{other.val} {
+        if (val < 0) {
+          throw std::runtime_error("copy");
+        }
+      }
+      ThrowOnCopy(ThrowOnCopy&&) = default;
+      ThrowOnCopy& operator=(ThrowOnCopy&&) = default;
+    };
+    UnrolledList<ThrowOnCopy, 4> l;
+    l.emplace_back(1);
+    l.emplace_back(2);
+    ThrowOnCopy bad{-1};
+    bool threw = false;
+    try {
+      l.insert(l.begin(), bad);
+    }
+    catch (const std::runtime_error&) {
+      threw = true;
+    }
+    assert(threw && l.size() == 2 && l.begin()->val == 1 && std::next(l.begin())->val == 2);
+    // Throwing into a fresh node, on an empty list and past a full tail : no empty node is left behind
+    UnrolledList<ThrowOnCopy, 2> empty;
+    for (int round = 0; round < 2; round++) {
+      threw = false;
+      try {
+        empty.push_back(bad);
+      }
+      catch (const std::runtime_error&) {
+        threw = true;
+      }
+      assert(threw && empty.size() == 2 * static_cast<size_t>(round) && empty.nodeCount() == static_cast<size_t>(round));
+      assert(std::distance(empty.begin(), empty.end()) == 2 * round);
+      empty.emplace_back(round);
+      empty.emplace_back(round);
+    }
+  }
+  {
+    // Erase keeps every node but the tail at least half full, for tiny K as well
+    auto check = [](auto list, std::vector<int> expected, size_t k) {
+      std::mt19937 rng{7};
+      while (!expected.empty()) {
+        size_t pos = rng() % expected.size();
+        auto it = list.erase(std::next(list.begin(), static_cast<long>(pos)));
+        expected.erase(expected.begin() + static_cast<long>(pos));
+        assert(pos == expected.size() ? it == list.end() : *it == expected[pos]);
+        assert(std::equal(list.begin(), list.end(), expected.begin(), expected.end()));
+        assert(list.nodeCount() <= expected.size() / std::max<size_t>(1, k / 2) + 1);
+      }
+      assert(list.nodeCount() == 0);
+    };
+    std::vector<int> values(200);
+    for (int i = 0; i < 200; i++) {
+      values[i] = i;
+    }
+    UnrolledList<int, 2> k2;
+    UnrolledList<int, 3> k3;
+    UnrolledList<int, 8> k8;
+    for (int v : values) {
+      k2.push_back(v);
+      k3.push_back(v);
+      k8.push_back(v);
+    }
+    check(k2, values, 2);
+    check(k3, values, 3);
+    check(k8, values, 8);
+    // Erasing 3 of every 4 elements used to leave nodes a quarter full
+    auto it = k8.begin();
+    for (int i = 0; it != k8.end(); i++) {
+      it = (i % 4 != 0 ? k8.erase(it) : std::next(it));
+    }
+    assert(k8.size() == 50 && k8.nodeCount() <= 50 / 4 + 1);
+  }
+
+  // Benchmark : iteration and mid list insertion against std::list / std::vector
+  // (same layouts as List / Vector, which live in their own files)
+  {
+    size_t n = 10'000'000;
+    UnrolledList<int, 16> unrolled;
+    std::list<int> list;
+    std::vector<int> vec;
+    for (size_t i = 0; i < n; i++) {
+      unrolled.push_back(static_cast<int>(i));
+      list.push_back(static_cast<int>(i));
+      vec.push_back(static_cast<int>(i));
+    }
+    long long s1 = 0, s2 = 0, s3 = 0;
+    std::cout << "UnrolledList iterate took " << benchmarkIterate(unrolled, s1) << " nanoseconds!\n";
+    std::cout << "list iterate took " << benchmarkIterate(list, s2) << " nanoseconds!\n";
+    std::cout << "vector iterate took " << benchmarkIterate(vec, s3) << " nanoseconds!\n";
+    assert(s1 == s2 && s2 == s3);
+
+    size_t nInserts = 10'000;
+    std::cout << "UnrolledList mid insert took " << benchmarkMidInsert(unrolled, nInserts) << " nanoseconds!\n";
+    std::cout << "list mid insert took " << benchmarkMidInsert(list, nInserts) << " nanoseconds!\n";
+    std::cout << "vector mid insert took " << benchmarkMidInsert(vec, nInserts) << " nanoseconds!\n";
+  }
+}
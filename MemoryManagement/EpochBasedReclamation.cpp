@@ -0,0 +1,860 @@
+#include<iostream>
+#include<cassert>
+#include<cstdint>
+#include<atomic>
+#include<vector>
+#include<thread>
+#include<mutex>
+#include<algorithm>
+#include<chrono>
+#include<random>
+#include<new>
+
+/*
+Epoch based reclamation (EBR) for lock free containers : a removed node is retired instead of freed,
+and freed once no reader can still hold a pointer to it
+    - Global epoch, every thread that uses the domain attaches a Participant (one record in the domain)
+    - Readers pin : record announces the epoch they entered in, unpin marks the record quiescent
+      pins nest, only the outermost one touches the record
+    - Retire : object goes to the participant's own retire list tagged with the current epoch, no shared state
+    - Every BATCH retires the participant tries to advance the epoch (all pinned records saw the current one)
+      and frees, in one pass, everything retired at least 2 epochs ago
+    - Freeing goes through a Reclaimer, consecutive objects with the same Reclaimer are handed over in one call,
+      so a pool backed reclaimer takes its lock once per batch
+    - Participant leaving with objects still retired hands them to the domain (orphans), freed on a later collect
+    - drain() frees every orphan right away : call it before a Reclaimer orphans may point to is destroyed
+
+A pinned thread that sleeps blocks reclamation for everyone : memory is unbounded in that case
+check: HazardPointerBaseline below for the per pointer alternative
+*/
+
+// Where retired objects go once no reader can reach them
+struct Reclaimer {
+  virtual void reclaim(void* const* ptrs, size_t n) = 0;
+protected:
+  ~Reclaimer() = default;
+};
+
+// Plain delete
+template<typename T>
+struct DeleteReclaimer final : Reclaimer {
+  void reclaim(void* const* ptrs, size_t n) override {
+    for (size_t i = 0; i < n; i++) {
+      delete static_cast<T*>(ptrs[i]);
+    }
+  }
+  static DeleteReclaimer& instance() {
+    static DeleteReclaimer reclaimer;
+    return reclaimer;
+  }
+};
+
+class SpinLock {
+  std::atomic_flag m_flag = ATOMIC_FLAG_INIT;
+public:
+  void lock() {
+    while (m_flag.test_and_set(std::memory_order_acquire)) {
+#if defined(__x86_64__) || defined(__i386__)
+      __builtin_ia32_pause();
+#endif
+    }
+  }
+  void unlock() {
+    m_flag.clear(std::memory_order_release);
+  }
+};
+
+/*
+  MemoryPool (MonotonicAllocator.cpp) behind a spin lock, so the writer allocating and
+  the reclaiming thread can share it, reclaim() returns a whole batch under one lock
+*/
+template<typename T>
+class SharedMemoryPool final : public Reclaimer {
+  SpinLock m_lock;
+  std::vector<T*> m_pool; // Stores available memory for allocation
+  std::vector<void*> m_toFree; // Stores allocations to delete on Dtor
+  size_t m_reallocSize{0};
+  size_t m_numAllocated{0};
+
+  void resize(size_t nAllocations) {
+    void* rawBytes = ::operator new[](nAllocations * sizeof(T), std::align_val_t(alignof(T)));
+    T* startAddress = reinterpret_cast<T*>(rawBytes);
+    for (size_t i = 0; i < nAllocations; i++) {
+      m_pool.push_back(startAddress + i);
+    }
+    m_toFree.push_back(rawBytes);
+    m_numAllocated += nAllocations;
+  }
+public:
+  explicit SharedMemoryPool(size_t nAllocations, size_t nReAllocSize = 1<<8) {
+    m_reallocSize = std::max<size_t>(nReAllocSize, 1);
+    if (nAllocations != 0) {
+      resize(nAllocations);
+    }
+  }
+  // Rule of 5 : Disable Copy / Move
+  ~SharedMemoryPool() {
+    // User needs to ensure every object was reclaimed, otherwise their Dtors never run
+    for (void* toFree : m_toFree) {
+      ::operator delete[](toFree, std::align_val_t(alignof(T)));
+    }
+  }
+  SharedMemoryPool(const SharedMemoryPool&) = delete;
+  SharedMemoryPool& operator=(const SharedMemoryPool&) = delete;
+  // Rule of 5 end
+
+  template<typename... ArgsT>
+  T* make(ArgsT&&... args) {
+    static_assert(std::is_nothrow_constructible_v<T, ArgsT...>, "SharedMemoryPool::make requires nothrow construction");
+    T* ptr;
+    {
+      std::lock_guard<SpinLock> guard{m_lock};
+      if (m_pool.empty()) {
+        resize(m_reallocSize);
+      }
+      ptr = m_pool.back();
+      m_pool.pop_back();
+    }
+    return new (ptr) T(std::forward<ArgsT>(args)...);
+  }
+  void dealloc(T* ptr) {
+    reclaim(reinterpret_cast<void* const*>(&ptr), 1);
+  }
+  void reclaim(void* const* ptrs, size_t n) override {
+    // Dtors run outside the lock
+    for (size_t i = 0; i < n; i++) {
+      static_cast<T*>(ptrs[i])->~T();
+    }
+    std::lock_guard<SpinLock> guard{m_lock};
+    for (size_t i = 0; i < n; i++) {
+      m_pool.push_back(static_cast<T*>(ptrs[i]));
+    }
+  }
+
+  // Getters
+  size_t allocated() {
+    std::lock_guard<SpinLock> guard{m_lock};
+    return m_numAllocated;
+  }
+  size_t available() {
+    std::lock_guard<SpinLock> guard{m_lock};
+    return m_pool.size();
+  }
+};
+
+class EbrDomain {
+  static constexpr uint64_t ACTIVE = uint64_t{1} << 63;
+
+  // One per attached thread, recycled once the thread detaches. Never freed before the domain
+  struct alignas(64) Record {
+    std::atomic<uint64_t> epoch{0}; // ACTIVE | epoch while pinned, 0 when quiescent
+    std::atomic<bool> inUse{true};
+    Record* next{nullptr}; // Immutable once published
+  };
+  struct Retired {
+    void* ptr;
+    Reclaimer* reclaimer;
+    uint64_t epoch;
+  };
+
+  alignas(64) std::atomic<uint64_t> m_globalEpoch{0};
+  alignas(64) std::atomic<Record*> m_records{nullptr}; // Push only list
+  std::mutex m_orphanLock;
+  std::vector<Retired> m_orphans;
+  std::atomic<bool> m_hasOrphans{false};
+  size_t m_batchSize;
+
+  Record* acquireRecord() {
+    for (Record* rec = m_records.load(std::memory_order_acquire); rec != nullptr; rec = rec->next) {
+      bool free = false;
+      if (!rec->inUse.load(std::memory_order_relaxed) && rec->inUse.compare_exchange_strong(free, true, std::memory_order_acquire)) {
+        return rec;
+      }
+    }
+    Record* rec = new Record();
+    Record* head = m_records.load(std::memory_order_relaxed);
+    do {
+      rec->next = head;
+    } while (!m_records.compare_exchange_weak(head, rec, std::memory_order_release, std::memory_order_relaxed));
+    return rec;
+  }
+
+  // Frees entries of retired at least 2 epochs old, keeps the rest in retired
+  static void freeOld(std::vector<Retired>& retired, uint64_t globalEpoch, std::vector<void*>& scratch) {
+    size_t kept = 0;
+    size_t i = 0;
+    while (i < retired.size()) {
+      if (retired[i].epoch + 2 > globalEpoch) {
+        retired[kept++] = retired[i++];
+        continue;
+      }
+      // Hand over a run of freeable entries sharing one reclaimer
+      Reclaimer* reclaimer = retired[i].reclaimer;
+      scratch.clear();
+      while (i < retired.size() && retired[i].reclaimer == reclaimer && retired[i].epoch + 2 <= globalEpoch) {
+        scratch.push_back(retired[i++].ptr);
+      }
+      reclaimer->reclaim(scratch.data(), scratch.size());
+    }
+    retired.resize(kept);
+  }
+
+  void collectOrphans(std::vector<void*>& scratch) {
+    if (!m_hasOrphans.load(std::memory_order_relaxed)) return;
+    std::unique_lock<std::mutex> lock{m_orphanLock, std::try_to_lock};
+    if (!lock.owns_lock()) return;
+    freeOld(m_orphans, m_globalEpoch.load(std::memory_order_seq_cst), scratch);
+    m_hasOrphans.store(!m_orphans.empty(), std::memory_order_relaxed);
+  }
+
+public:
+  class Participant;
+
+  // Pinned while alive, pointers read from the container stay valid until it goes out of scope
+  class Guard {
+    Participant* m_participant;
+  public:
+    explicit Guard(Participant& participant) : m_participant{&participant} {
+      participant.enter();
+    }
+    ~Guard() {
+      m_participant->exit();
+    }
+    Guard(const Guard&) = delete;
+    Guard& operator=(const Guard&) = delete;
+  };
+
+  // Per thread handle, not shareable between threads
+  class Participant {
+    EbrDomain* m_domain{nullptr};
+    Record* m_record{nullptr};
+    size_t m_pinDepth{0};
+    size_t m_sinceCollect{0};
+    std::vector<Retired> m_retired;
+    std::vector<void*> m_scratch;
+
+    friend class Guard;
+    friend class EbrDomain;
+
+    explicit Participant(EbrDomain& domain) : m_domain{&domain}, m_record{domain.acquireRecord()} {
+      m_retired.reserve(domain.m_batchSize * 2);
+    }
+    void enter() {
+      if (m_pinDepth++ != 0) return;
+      uint64_t epoch = m_domain->m_globalEpoch.load(std::memory_order_relaxed);
+      // seq_cst RMW : announcement is visible before any pointer the reader loads afterwards
+      m_record->epoch.exchange(epoch | ACTIVE, std::memory_order_seq_cst);
+    }
+    void exit() {
+      assert(m_pinDepth != 0);
+      if (--m_pinDepth != 0) return;
+      m_record->epoch.store(0, std::memory_order_release);
+    }
+  public:
+    // Rule of 5 : move only
+    Participant(Participant&& other) noexcept :
+        m_domain{other.m_domain}, m_record{other.m_record}, m_pinDepth{other.m_pinDepth},
+        m_sinceCollect{other.m_sinceCollect}, m_retired{std::move(other.m_retired)}, m_scratch{std::move(other.m_scratch)} {
+      other.m_domain = nullptr;
+      other.m_record = nullptr;
+    }
+    Participant& operator=(Participant&&) = delete;
+    Participant(const Participant&) = delete;
+    Participant& operator=(const Participant&) = delete;
+    ~Participant() {
+      if (m_record == nullptr) return;
+      assert(m_pinDepth == 0 && "participant destroyed while pinned");
+      collect();
+      if (!m_retired.empty()) {
+        std::lock_guard<std::mutex> guard{m_domain->m_orphanLock};
+        m_domain->m_orphans.insert(m_domain->m_orphans.end(), m_retired.begin(), m_retired.end());
+        m_domain->m_hasOrphans.store(true, std::memory_order_relaxed);
+      }
+      m_record->inUse.store(false, std::memory_order_release);
+    }
+    // Rule of 5 end
+
+    Guard pin() {
+      return Guard{*this};
+    }
+    bool pinned() const {
+      return m_pinDepth != 0;
+    }
+
+    // ptr must already be unreachable for new readers
+    template<typename T>
+    void retire(T* ptr) {
+      retire(ptr, DeleteReclaimer<T>::instance());
+    }
+    template<typename T>
+    void retire(T* ptr, Reclaimer& reclaimer) {
+      m_retired.push_back({ptr, &reclaimer, m_domain->m_globalEpoch.load(std::memory_order_seq_cst)});
+      if (++m_sinceCollect >= m_domain->m_batchSize) {
+        collect();
+      }
+    }
+
+    // Tries to advance the epoch, then frees what is old enough
+    void collect() {
+      m_sinceCollect = 0;
+      m_domain->tryAdvance();
+      freeOld(m_retired, m_domain->m_globalEpoch.load(std::memory_order_seq_cst), m_scratch);
+      m_domain->collectOrphans(m_scratch);
+    }
+    size_t pendingCount() const {
+      return m_retired.size();
+    }
+  };
+
+  explicit EbrDomain(size_t batchSize = 64) : m_batchSize{std::max<size_t>(batchSize, 1)} {}
+
+  // Rule of 5 : participants point into the domain
+  ~EbrDomain() {
+    // Every participant is gone, nobody can be reading
+    std::vector<void*> scratch;
+    freeOld(m_orphans, UINT64_MAX, scratch);
+    Record* rec = m_records.load(std::memory_order_acquire);
+    while (rec != nullptr) {
+      assert(!rec->inUse.load() && "domain destroyed with attached participants");
+      Record* next = rec->next;
+      delete rec;
+      rec = next;
+    }
+  }
+  EbrDomain(const EbrDomain&) = delete;
+  EbrDomain& operator=(const EbrDomain&) = delete;
+  // Rule of 5 end
+
+  Participant attach() {
+    return Participant{*this};
+  }
+
+  // Barrier : advances the epoch twice, then frees every orphan retired before the call
+  // Waits for pinned readers to move on, so the calling thread must not be pinned
+  void drain() {
+    uint64_t target = m_globalEpoch.load(std::memory_order_seq_cst) + 2;
+    while (m_globalEpoch.load(std::memory_order_seq_cst) < target) {
+      if (!tryAdvance()) {
+        std::this_thread::yield();
+      }
+    }
+    std::vector<void*> scratch;
+    std::lock_guard<std::mutex> guard{m_orphanLock};
+    freeOld(m_orphans, m_globalEpoch.load(std::memory_order_seq_cst), scratch);
+    m_hasOrphans.store(!m_orphans.empty(), std::memory_order_relaxed);
+  }
+
+  // Advances the epoch if every pinned participant entered in the current one
+  bool tryAdvance() {
+    uint64_t epoch = m_globalEpoch.load(std::memory_order_seq_cst);
+    for (Record* rec = m_records.load(std::memory_order_acquire); rec != nullptr; rec = rec->next) {
+      uint64_t announced = rec->epoch.load(std::memory_order_seq_cst);
+      if ((announced & ACTIVE) && (announced & ~ACTIVE) != epoch) {
+        return false;
+      }
+    }
+    return m_globalEpoch.compare_exchange_strong(epoch, epoch + 1, std::memory_order_seq_cst);
+  }
+  uint64_t epoch() const {
+    return m_globalEpoch.load(std::memory_order_relaxed);
+  }
+  size_t recordCount() const {
+    size_t count = 0;
+    for (Record* rec = m_records.load(std::memory_order_acquire); rec != nullptr; rec = rec->next) {
+      count++;
+    }
+    return count;
+  }
+};
+
+/*
+Baseline for the comparison : classic hazard pointers
+    - Each participant publishes up to SLOTS pointers it is about to dereference
+    - A protect is a store + full fence + reload per node, that is the read side cost EBR avoids
+    - Retire scans all slots every THRESHOLD retires and frees what no slot holds : bounded garbage
+*/
+class HazardPointerBaseline {
+public:
+  static constexpr size_t SLOTS = 2;
+private:
+  struct alignas(64) Record {
+    std::atomic<void*> slots[SLOTS]{};
+    std::atomic<bool> inUse{true};
+    Record* next{nullptr};
+  };
+  struct Retired {
+    void* ptr;
+    Reclaimer* reclaimer;
+  };
+  std::atomic<Record*> m_records{nullptr};
+  std::mutex m_orphanLock;
+  std::vector<Retired> m_orphans;
+  size_t m_threshold;
+
+  Record* acquireRecord() {
+    for (Record* rec = m_records.load(std::memory_order_acquire); rec != nullptr; rec = rec->next) {
+      bool free = false;
+      if (!rec->inUse.load(std::memory_order_relaxed) && rec->inUse.compare_exchange_strong(free, true, std::memory_order_acquire)) {
+        return rec;
+      }
+    }
+    Record* rec = new Record();
+    Record* head = m_records.load(std::memory_order_relaxed);
+    do {
+      rec->next = head;
+    } while (!m_records.compare_exchange_weak(head, rec, std::memory_order_release, std::memory_order_relaxed));
+    return rec;
+  }
+
+public:
+  class Participant {
+    HazardPointerBaseline* m_domain{nullptr};
+    Record* m_record{nullptr};
+    std::vector<Retired> m_retired;
+    std::vector<void*> m_hazards;
+    friend class HazardPointerBaseline;
+    explicit Participant(HazardPointerBaseline& domain) : m_domain{&domain}, m_record{domain.acquireRecord()} {}
+  public:
+    Participant(Participant&& other) noexcept :
+        m_domain{other.m_domain}, m_record{other.m_record}, m_retired{std::move(other.m_retired)} {
+      other.m_record = nullptr;
+    }
+    Participant(const Participant&) = delete;
+    Participant& operator=(const Participant&) = delete;
+    Participant& operator=(Participant&&) = delete;
+    ~Participant() {
+      if (m_record == nullptr) return;
+      clear();
+      scan();
+      if (!m_retired.empty()) {
+        std::lock_guard<std::mutex> guard{m_domain->m_orphanLock};
+        m_domain->m_orphans.insert(m_domain->m_orphans.end(), m_retired.begin(), m_retired.end());
+      }
+      m_record->inUse.store(false, std::memory_order_release);
+    }
+
+    // Publishes ptr in slot, caller must re-validate that ptr is still reachable before using it
+    void protect(size_t slot, void* ptr) {
+      m_record->slots[slot].store(ptr, std::memory_order_seq_cst);
+    }
+    void clear() {
+      for (auto& slot : m_record->slots) {
+        slot.store(nullptr, std::memory_order_release);
+      }
+    }
+    template<typename T>
+    void retire(T* ptr, Reclaimer& reclaimer) {
+      m_retired.push_back({ptr, &reclaimer});
+      if (m_retired.size() >= m_domain->m_threshold) {
+        scan();
+      }
+    }
+    void scan() {
+      m_hazards.clear();
+      for (Record* rec = m_domain->m_records.load(std::memory_order_acquire); rec != nullptr; rec = rec->next) {
+        for (auto& slot : rec->slots) {
+          if (void* ptr = slot.load(std::memory_order_seq_cst)) {
+            m_hazards.push_back(ptr);
+          }
+        }
+      }
+      std::sort(m_hazards.begin(), m_hazards.end());
+      size_t kept = 0;
+      for (Retired& r : m_retired) {
+        if (std::binary_search(m_hazards.begin(), m_hazards.end(), r.ptr)) {
+          m_retired[kept++] = r;
+        }
+        else {
+          r.reclaimer->reclaim(&r.ptr, 1);
+        }
+      }
+      m_retired.resize(kept);
+    }
+  };
+
+  explicit HazardPointerBaseline(size_t threshold = 64) : m_threshold{std::max<size_t>(threshold, 1)} {}
+  ~HazardPointerBaseline() {
+    for (Retired& r : m_orphans) {
+      r.reclaimer->reclaim(&r.ptr, 1);
+    }
+    Record* rec = m_records.load(std::memory_order_acquire);
+    while (rec != nullptr) {
+      Record* next = rec->next;
+      delete rec;
+      rec = next;
+    }
+  }
+  HazardPointerBaseline(const HazardPointerBaseline&) = delete;
+  HazardPointerBaseline& operator=(const HazardPointerBaseline&) = delete;
+
+  Participant attach() {
+    return Participant{*this};
+  }
+
+  // Frees every orphan no slot protects, same contract as EbrDomain::drain
+  void drain() {
+    std::vector<void*> hazards;
+    for (Record* rec = m_records.load(std::memory_order_acquire); rec != nullptr; rec = rec->next) {
+      for (auto& slot : rec->slots) {
+        if (void* ptr = slot.load(std::memory_order_seq_cst)) {
+          hazards.push_back(ptr);
+        }
+      }
+    }
+    std::sort(hazards.begin(), hazards.end());
+    std::lock_guard<std::mutex> guard{m_orphanLock};
+    size_t kept = 0;
+    for (Retired& r : m_orphans) {
+      if (std::binary_search(hazards.begin(), hazards.end(), r.ptr)) {
+        m_orphans[kept++] = r;
+      }
+      else {
+        r.reclaimer->reclaim(&r.ptr, 1);
+      }
+    }
+    m_orphans.resize(kept);
+  }
+};
+
+/*
+Read mostly sorted set : readers traverse without locks, writers serialize on a mutex
+    - Remove marks the victim's next pointer (low bit) before unlinking it, so a hazard pointer reader
+      standing on a removed node sees the mark when it re-validates and restarts from head
+    - Removed nodes are retired to the Domain, nodes come from a SharedMemoryPool and go back to it
+    - Participants that removed from the set must detach before it dies, its Dtor drains the domain's orphans
+      so none of them is left pointing into the pool
+*/
+template<typename Domain>
+class ReadMostlySet {
+  static constexpr uintptr_t MARK = 1;
+  struct Node {
+    int key;
+    std::atomic<uintptr_t> next{0};
+    explicit Node(int key_) noexcept : key{key_} {}
+    ~Node() {
+      key = INT32_MIN; // Poison : a reader seeing it touched reclaimed memory
+    }
+  };
+  static Node* ptrOf(uintptr_t val) {
+    return reinterpret_cast<Node*>(val & ~MARK);
+  }
+
+  Domain& m_domain;
+  std::atomic<uintptr_t> m_head{0};
+  std::mutex m_writeLock;
+  SharedMemoryPool<Node> m_pool{1 << 10};
+  Reclaimer& m_reclaimer;
+
+  // Writer only : field that points at the first node with key >= key
+  std::atomic<uintptr_t>* findSlot(int key) {
+    std::atomic<uintptr_t>* prev = &m_head;
+    Node* cur = ptrOf(prev->load(std::memory_order_relaxed));
+    while (cur != nullptr && cur->key < key) {
+      prev = &cur->next;
+      cur = ptrOf(prev->load(std::memory_order_relaxed));
+    }
+    return prev;
+  }
+public:
+  using Participant = typename Domain::Participant;
+
+  // useHeap : retire to plain delete instead of the pool, lets ASAN see use after free
+  explicit ReadMostlySet(Domain& domain, bool useHeap = false) :
+      m_domain{domain},
+      m_reclaimer{useHeap ? static_cast<Reclaimer&>(DeleteReclaimer<Node>::instance()) : static_cast<Reclaimer&>(m_pool)} {}
+  // Rule of 5 : no copy, all retired nodes must be reclaimed before the set dies
+  ReadMostlySet(const ReadMostlySet&) = delete;
+  ReadMostlySet& operator=(const ReadMostlySet&) = delete;
+  ~ReadMostlySet() {
+    // Orphaned nodes go back to m_pool while it is still alive
+    m_domain.drain();
+    Node* cur = ptrOf(m_head.load(std::memory_order_relaxed));
+    while (cur != nullptr) {
+      Node* next = ptrOf(cur->next.load(std::memory_order_relaxed));
+      m_reclaimer.reclaim(reinterpret_cast<void* const*>(&cur), 1);
+      cur = next;
+    }
+  }
+  // Rule of 5 end
+
+  bool insert(int key) {
+    Node* node = (&m_reclaimer == &m_pool ? m_pool.make(key) : new Node(key));
+    std::lock_guard<std::mutex> guard{m_writeLock};
+    std::atomic<uintptr_t>* slot = findSlot(key);
+    uintptr_t next = slot->load(std::memory_order_relaxed);
+    if (ptrOf(next) != nullptr && ptrOf(next)->key == key) {
+      m_reclaimer.reclaim(reinterpret_cast<void* const*>(&node), 1); // Never published
+      return false;
+    }
+    node->next.store(next, std::memory_order_relaxed);
+    slot->store(reinterpret_cast<uintptr_t>(node), std::memory_order_release);
+    return true;
+  }
+
+  bool remove(int key, Participant& participant) {
+    Node* victim;
+    {
+      std::lock_guard<std::mutex> guard{m_writeLock};
+      std::atomic<uintptr_t>* slot = findSlot(key);
+      victim = ptrOf(slot->load(std::memory_order_relaxed));
+      if (victim == nullptr || victim->key != key) {
+        return false;
+      }
+      uintptr_t next = victim->next.fetch_or(MARK, std::memory_order_acq_rel);
+      slot->store(next, std::memory_order_release);
+    }
+    participant.retire(victim, m_reclaimer);
+    return true;
+  }
+
+  bool contains(int key, Participant& participant) const {
+    if constexpr (std::is_same_v<Domain, EbrDomain>) {
+      auto guard = participant.pin();
+      Node* cur = ptrOf(m_head.load(std::memory_order_acquire));
+      while (cur != nullptr && cur->key < key) {
+        assert(cur->key != INT32_MIN && "reader reached a reclaimed node");
+        cur = ptrOf(cur->next.load(std::memory_order_acquire));
+      }
+      return cur != nullptr && cur->key == key;
+    }
+    else {
+      // Hand over hand : slot (i & 1) holds cur, the other one holds prev
+      while (true) {
+        const std::atomic<uintptr_t>* prev = &m_head;
+        Node* cur = ptrOf(prev->load(std::memory_order_acquire));
+        size_t slot = 0;
+        bool restart = false;
+        while (cur != nullptr) {
+          participant.protect(slot, cur);
+          if (prev->load(std::memory_order_acquire) != reinterpret_cast<uintptr_t>(cur)) {
+            restart = true; // prev was removed or cur was unlinked
+            break;
+          }
+          assert(cur->key != INT32_MIN && "reader reached a reclaimed node");
+          if (cur->key >= key) {
+            break;
+          }
+          prev = &cur->next;
+          cur = ptrOf(prev->load(std::memory_order_acquire));
+          slot ^= 1;
+        }
+        if (restart) continue;
+        bool found = cur != nullptr && cur->key == key;
+        participant.clear();
+        return found;
+      }
+    }
+  }
+};
+
+// Reclaimer that only counts, for lifetime tests
+struct CountingReclaimer final : Reclaimer {
+  std::atomic<size_t> reclaimed{0};
+  std::atomic<size_t> calls{0};
+  void reclaim(void* const* ptrs, size_t n) override {
+    for (size_t i = 0; i < n; i++) {
+      delete static_cast<int*>(ptrs[i]);
+    }
+    reclaimed += n;
+    calls++;
+  }
+};
+
+// Readers look up random keys while one writer removes and re-inserts them
+template<typename Domain>
+void stressTest(size_t nReaders, size_t nWriterOps, bool useHeap) {
+  Domain domain{32};
+  {
+    ReadMostlySet<Domain> set{domain, useHeap};
+    constexpr int N_KEYS = 256;
+    for (int k = 0; k < N_KEYS; k += 2) {
+      set.insert(k);
+    }
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> readers;
+    for (size_t r = 0; r < nReaders; r++) {
+      readers.emplace_back([&domain, &set, &stop, r]() {
+        auto participant = domain.attach();
+        std::mt19937 rng{static_cast<uint32_t>(r)};
+        while (!stop.load(std::memory_order_relaxed)) {
+          int key = static_cast<int>(rng() % N_KEYS);
+          set.contains(key, participant);
+          assert(!set.contains(key | 1, participant)); // Odd keys never exist
+        }
+      });
+    }
+    {
+      auto participant = domain.attach();
+      std::mt19937 rng{1234};
+      for (size_t i = 0; i < nWriterOps; i++) {
+        int key = static_cast<int>(rng() % N_KEYS) & ~1;
+        if (!set.remove(key, participant)) {
+          set.insert(key);
+        }
+      }
+      stop = true;
+      for (auto& t : readers) {
+        t.join();
+      }
+    } // Writer participant hands leftovers to the domain
+  } // Set dies before the domain : its Dtor drains the orphans that point into its pool
+}
+
+// Read heavy : readers look up keys, one writer updates every few microseconds
+template<typename Domain>
+void benchmarkReadHeavy(const char* name, size_t nReaders, size_t nLookupsPerReader) {
+  Domain domain{64};
+  ReadMostlySet<Domain> set{domain};
+  constexpr int N_KEYS = 256;
+  for (int k = 0; k < N_KEYS; k += 2) {
+    set.insert(k);
+  }
+  std::atomic<bool> go{false};
+  std::atomic<size_t> done{0};
+  std::atomic<size_t> hits{0};
+  std::vector<std::thread> readers;
+  for (size_t r = 0; r < nReaders; r++) {
+    readers.emplace_back([&, r]() {
+      auto participant = domain.attach();
+      uint32_t x = static_cast<uint32_t>(r) * 2654435761u + 1;
+      size_t local = 0;
+      while (!go.load(std::memory_order_acquire)) {}
+      for (size_t i = 0; i < nLookupsPerReader; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        local += set.contains(static_cast<int>(x % N_KEYS), participant);
+      }
+      hits += local;
+      done++;
+    });
+  }
+  auto participant = domain.attach();
+  auto start = std::chrono::high_resolution_clock::now();
+  go.store(true, std::memory_order_release);
+  size_t updates = 0;
+  while (done.load(std::memory_order_acquire) != nReaders) {
+    int key = static_cast<int>(updates * 7 % N_KEYS) & ~1;
+    set.remove(key, participant);
+    set.insert(key);
+    updates++;
+    std::this_thread::sleep_for(std::chrono::microseconds(20));
+  }
+  for (auto& t : readers) {
+    t.join();
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  std::cout << name << ", " << nReaders << " readers : " << nReaders * nLookupsPerReader << " lookups (" << updates
+            << " updates) took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+}
+
+int main() {
+  // Pinned reader blocks reclamation, unpinning lets it through
+  {
+    EbrDomain domain{1};
+    CountingReclaimer reclaimer;
+    auto reader = domain.attach();
+    auto writer = domain.attach();
+    {
+      auto guard = reader.pin();
+      {
+        auto nested = reader.pin();
+      }
+      assert(reader.pinned());
+      writer.retire(new int(1), reclaimer);
+      for (int i = 0; i < 10; i++) {
+        writer.collect();
+      }
+      assert(reclaimer.reclaimed == 0 && writer.pendingCount() == 1);
+      assert(domain.epoch() <= 1); // Reader holds the epoch back
+    }
+    assert(!reader.pinned());
+    writer.collect();
+    writer.collect();
+    assert(reclaimer.reclaimed == 1 && writer.pendingCount() == 0);
+  }
+  // Batch : one reclaim call per run of same reclaimer
+  {
+    EbrDomain domain{1000};
+    CountingReclaimer reclaimer;
+    auto participant = domain.attach();
+    for (int i = 0; i < 100; i++) {
+      participant.retire(new int(i), reclaimer);
+    }
+    participant.collect();
+    participant.collect();
+    assert(reclaimer.reclaimed == 100 && reclaimer.calls == 1);
+  }
+  // Orphans : a participant that leaves with pending objects hands them to the domain
+  {
+    EbrDomain domain{1000};
+    CountingReclaimer reclaimer;
+    auto reader = domain.attach();
+    {
+      auto guard = reader.pin();
+      std::thread([&domain, &reclaimer]() {
+        auto participant = domain.attach();
+        participant.retire(new int(1), reclaimer);
+      }).join();
+      assert(reclaimer.reclaimed == 0);
+    }
+    reader.collect();
+    reader.collect();
+    assert(reclaimer.reclaimed == 1);
+  }
+  // Records are recycled
+  {
+    EbrDomain domain;
+    for (int i = 0; i < 4; i++) {
+      std::thread([&domain]() {
+        auto participant = domain.attach();
+        auto guard = participant.pin();
+      }).join();
+    }
+    assert(domain.recordCount() == 1);
+  }
+  // Pool reclaim : nodes go back to the pool
+  {
+    EbrDomain domain{4};
+    SharedMemoryPool<int> pool{8, 8};
+    auto participant = domain.attach();
+    for (int i = 0; i < 64; i++) {
+      participant.retire(pool.make(i), pool);
+    }
+    participant.collect();
+    participant.collect();
+    assert(participant.pendingCount() == 0 && pool.available() == pool.allocated());
+    assert(pool.allocated() < 64); // Reclaimed nodes were reused by later make calls
+  }
+  // Drain : orphans are freed before the pool they point into dies
+  {
+    EbrDomain domain{1000};
+    {
+      SharedMemoryPool<int> pool{8, 8};
+      {
+        auto participant = domain.attach();
+        participant.retire(pool.make(1), pool);
+      }
+      domain.drain();
+      assert(pool.available() == pool.allocated());
+    }
+    ReadMostlySet<EbrDomain> set{domain};
+    {
+      auto participant = domain.attach();
+      set.insert(1);
+      assert(set.remove(1, participant));
+    } // Detach : the removed node becomes an orphan, the set Dtor drains it back to its pool
+  }
+
+  stressTest<EbrDomain>(4, 200'000, true);
+  stressTest<EbrDomain>(4, 200'000, false);
+  stressTest<HazardPointerBaseline>(4, 200'000, true);
+  stressTest<HazardPointerBaseline>(4, 200'000, false);
+
+  // Benchmark : EBR vs hazard pointers, read heavy
+  for (size_t nReaders : {1, 2, 4}) {
+    size_t nLookups = 2'000'000;
+    benchmarkReadHeavy<EbrDomain>("EBR", nReaders, nLookups);
+    benchmarkReadHeavy<HazardPointerBaseline>("HazardPointers", nReaders, nLookups);
+  }
+}
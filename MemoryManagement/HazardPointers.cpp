@@ -0,0 +1,696 @@
+#include<iostream>
+#include<cassert>
+#include<cstdint>
+#include<atomic>
+#include<vector>
+#include<thread>
+#include<mutex>
+#include<queue>
+#include<algorithm>
+#include<chrono>
+#include<bit>
+#if defined(__linux__)
+#include<sys/syscall.h>
+#include<unistd.h>
+#include<linux/membarrier.h>
+#endif
+
+/*
+Hazard pointers : safe memory reclamation with bounded garbage
+    - Each thread attaches a Participant, which owns a record of SLOTS hazard slots in the domain
+    - A reader publishes the pointer it is about to dereference in a slot, then re-reads the source
+      to check the object was still reachable after publication (protect)
+    - Retire : object goes to the participant's own list, once the list reaches the threshold the
+      participant scans every slot and frees whatever no slot holds
+    - Threshold is max(minThreshold, 2 * total slots) : at most total slots objects survive a scan,
+      so a scan frees at least half of the list and garbage per participant stays bounded,
+      even if a reader sleeps while holding a hazard (it pins only the objects in its slots, EBR pins everything)
+    - Participant leaving with objects still retired hands them to the domain, the next scan adopts them
+
+Fence modes, what makes the reader's publication visible to a scan
+    - Symmetric : reader publishes with a seq_cst exchange (full fence on every protect), scan uses a fence
+    - Asymmetric : reader publishes with a plain store + compiler barrier, scan issues
+      membarrier(PRIVATE_EXPEDITED) which runs a full fence on every core running this process.
+      Reads get cheap, scans get expensive, which the threshold amortizes.
+      Falls back to Symmetric if membarrier is unavailable, and under TSAN which can not see it
+
+Data structure side : unlink stores must be seq_cst (or followed by one) before retire
+check: EpochBasedReclamation.cpp for the epoch scheme and its comparison against hazard pointers
+*/
+enum class FenceMode {
+  Symmetric,
+  Asymmetric
+};
+
+#if defined(__SANITIZE_THREAD__)
+#define HAZARD_TSAN 1
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define HAZARD_TSAN 1
+#endif
+#endif
+
+// Where retired objects go once no hazard holds them
+struct Reclaimer {
+  virtual void reclaim(void* const* ptrs, size_t n) = 0;
+protected:
+  ~Reclaimer() = default;
+};
+
+template<typename T>
+struct DeleteReclaimer final : Reclaimer {
+  void reclaim(void* const* ptrs, size_t n) override {
+    for (size_t i = 0; i < n; i++) {
+      delete static_cast<T*>(ptrs[i]);
+    }
+  }
+  static DeleteReclaimer& instance() {
+    static DeleteReclaimer reclaimer;
+    return reclaimer;
+  }
+};
+
+class HazardDomain {
+public:
+  static constexpr size_t SLOTS = 4;
+private:
+  // One per attached thread, recycled once the thread detaches. Never freed before the domain
+  struct alignas(64) Record {
+    std::atomic<void*> slots[SLOTS]{};
+    std::atomic<bool> inUse{true};
+    Record* next{nullptr}; // Immutable once published
+  };
+  struct Retired {
+    void* ptr;
+    Reclaimer* reclaimer;
+  };
+
+  alignas(64) std::atomic<Record*> m_records{nullptr}; // Push only list
+  std::atomic<size_t> m_nRecords{0};
+  std::mutex m_orphanLock;
+  std::vector<Retired> m_orphans;
+  std::atomic<bool> m_hasOrphans{false};
+  size_t m_minThreshold;
+  bool m_asymmetric{false};
+
+  static bool registerMembarrier() {
+#if defined(__linux__) && defined(__NR_membarrier) && !defined(HAZARD_TSAN)
+    long supported = syscall(__NR_membarrier, MEMBARRIER_CMD_QUERY, 0, 0);
+    if (supported < 0 || !(supported & MEMBARRIER_CMD_PRIVATE_EXPEDITED)) {
+      return false;
+    }
+    return syscall(__NR_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0, 0) == 0;
+#else
+    return false;
+#endif
+  }
+  // Scan side of the fence pair
+  void heavyFence() const {
+#if defined(__linux__) && defined(__NR_membarrier)
+    if (m_asymmetric) {
+      syscall(__NR_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0, 0);
+      return;
+    }
+#endif
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  }
+
+  Record* acquireRecord() {
+    for (Record* rec = m_records.load(std::memory_order_acquire); rec != nullptr; rec = rec->next) {
+      bool free = false;
+      if (!rec->inUse.load(std::memory_order_relaxed) && rec->inUse.compare_exchange_strong(free, true, std::memory_order_acquire)) {
+        return rec;
+      }
+    }
+    Record* rec = new Record();
+    Record* head = m_records.load(std::memory_order_relaxed);
+    do {
+      rec->next = head;
+    } while (!m_records.compare_exchange_weak(head, rec, std::memory_order_release, std::memory_order_relaxed));
+    m_nRecords.fetch_add(1, std::memory_order_relaxed);
+    return rec;
+  }
+
+public:
+  class Participant;
+
+  // Owns one slot of a participant, protects at most one object at a time
+  class HazardPointer {
+    Participant* m_participant{nullptr};
+    std::atomic<void*>* m_slot{nullptr};
+    size_t m_index{0};
+
+    friend class Participant;
+    HazardPointer(Participant& participant, size_t index) :
+        m_participant{&participant}, m_slot{&participant.m_record->slots[index]}, m_index{index} {}
+
+    void publish(void* ptr) {
+      if (m_participant->m_asymmetric) {
+        m_slot->store(ptr, std::memory_order_relaxed);
+        std::atomic_signal_fence(std::memory_order_seq_cst); // Scan's membarrier does the hardware part
+      }
+      else {
+        m_slot->exchange(ptr, std::memory_order_seq_cst);
+      }
+    }
+  public:
+    // Rule of 5 : move only, slot goes back to the participant on destruction
+    HazardPointer(HazardPointer&& other) noexcept :
+        m_participant{other.m_participant}, m_slot{other.m_slot}, m_index{other.m_index} {
+      other.m_participant = nullptr;
+    }
+    HazardPointer& operator=(HazardPointer&&) = delete;
+    HazardPointer(const HazardPointer&) = delete;
+    HazardPointer& operator=(const HazardPointer&) = delete;
+    ~HazardPointer() {
+      if (m_participant == nullptr) return;
+      reset();
+      m_participant->m_freeSlots |= (1u << m_index);
+    }
+    // Rule of 5 end
+
+    // Returns src's current value, safe to dereference until reset / next protect
+    template<typename T>
+    T* protect(const std::atomic<T*>& src) {
+      T* ptr = src.load(std::memory_order_relaxed);
+      while (!tryProtect(ptr, src)) {}
+      return ptr;
+    }
+    // One attempt : true if ptr is protected, otherwise ptr is updated to src's new value
+    template<typename T>
+    bool tryProtect(T*& ptr, const std::atomic<T*>& src) {
+      publish(ptr);
+      T* again = src.load(std::memory_order_seq_cst);
+      if (again == ptr) {
+        return true;
+      }
+      ptr = again;
+      return false;
+    }
+    // Publishes ptr without validation : ptr must already be protected by another hazard pointer
+    template<typename T>
+    void resetProtection(T* ptr) {
+      publish(ptr);
+    }
+    void reset() {
+      m_slot->store(nullptr, std::memory_order_release);
+    }
+  };
+
+  // Per thread handle, not shareable between threads
+  class Participant {
+    HazardDomain* m_domain{nullptr};
+    Record* m_record{nullptr};
+    bool m_asymmetric{false};
+    uint32_t m_freeSlots{(1u << SLOTS) - 1};
+    std::vector<Retired> m_retired;
+    std::vector<void*> m_hazards;
+
+    friend class HazardDomain;
+    friend class HazardPointer;
+
+    explicit Participant(HazardDomain& domain) :
+        m_domain{&domain}, m_record{domain.acquireRecord()}, m_asymmetric{domain.m_asymmetric} {}
+
+    size_t threshold() const {
+      return std::max(m_domain->m_minThreshold, 2 * SLOTS * m_domain->m_nRecords.load(std::memory_order_relaxed));
+    }
+  public:
+    // Rule of 5 : move only, hazard pointers must not outlive the move
+    Participant(Participant&& other) noexcept :
+        m_domain{other.m_domain}, m_record{other.m_record}, m_asymmetric{other.m_asymmetric},
+        m_freeSlots{other.m_freeSlots}, m_retired{std::move(other.m_retired)} {
+      other.m_record = nullptr;
+    }
+    Participant& operator=(Participant&&) = delete;
+    Participant(const Participant&) = delete;
+    Participant& operator=(const Participant&) = delete;
+    ~Participant() {
+      if (m_record == nullptr) return;
+      assert(m_freeSlots == (1u << SLOTS) - 1 && "participant destroyed with live hazard pointers");
+      scan();
+      if (!m_retired.empty()) {
+        std::lock_guard<std::mutex> guard{m_domain->m_orphanLock};
+        m_domain->m_orphans.insert(m_domain->m_orphans.end(), m_retired.begin(), m_retired.end());
+        m_domain->m_hasOrphans.store(true, std::memory_order_release);
+      }
+      m_record->inUse.store(false, std::memory_order_release);
+    }
+    // Rule of 5 end
+
+    HazardPointer makeHazardPointer() {
+      assert(m_freeSlots != 0 && "out of hazard slots");
+      size_t index = static_cast<size_t>(std::countr_zero(m_freeSlots));
+      m_freeSlots &= ~(1u << index);
+      return HazardPointer{*this, index};
+    }
+
+    // ptr must already be unreachable for new readers
+    template<typename T>
+    void retire(T* ptr) {
+      retire(ptr, DeleteReclaimer<T>::instance());
+    }
+    template<typename T>
+    void retire(T* ptr, Reclaimer& reclaimer) {
+      m_retired.push_back({ptr, &reclaimer});
+      if (m_retired.size() >= threshold()) {
+        scan();
+      }
+    }
+
+    // Frees every retired object no slot holds
+    void scan() {
+      if (m_domain->m_hasOrphans.load(std::memory_order_acquire)) {
+        std::unique_lock<std::mutex> lock{m_domain->m_orphanLock, std::try_to_lock};
+        if (lock.owns_lock()) {
+          m_retired.insert(m_retired.end(), m_domain->m_orphans.begin(), m_domain->m_orphans.end());
+          m_domain->m_orphans.clear();
+          m_domain->m_hasOrphans.store(false, std::memory_order_relaxed);
+        }
+      }
+      m_domain->heavyFence(); // Every publication before this point is visible to the loads below
+      m_hazards.clear();
+      for (Record* rec = m_domain->m_records.load(std::memory_order_acquire); rec != nullptr; rec = rec->next) {
+        for (auto& slot : rec->slots) {
+          if (void* ptr = slot.load(std::memory_order_seq_cst)) {
+            m_hazards.push_back(ptr);
+          }
+        }
+      }
+      std::sort(m_hazards.begin(), m_hazards.end());
+      size_t kept = 0;
+      for (Retired& r : m_retired) {
+        if (std::binary_search(m_hazards.begin(), m_hazards.end(), r.ptr)) {
+          m_retired[kept++] = r;
+        }
+        else {
+          r.reclaimer->reclaim(&r.ptr, 1);
+        }
+      }
+      m_retired.resize(kept);
+    }
+    size_t pendingCount() const {
+      return m_retired.size();
+    }
+    size_t retireThreshold() const {
+      return threshold();
+    }
+  };
+
+  explicit HazardDomain(FenceMode mode = FenceMode::Asymmetric, size_t minThreshold = 64) :
+      m_minThreshold{std::max<size_t>(minThreshold, 1)} {
+    m_asymmetric = (mode == FenceMode::Asymmetric && registerMembarrier());
+  }
+  // Rule of 5 : participants point into the domain
+  ~HazardDomain() {
+    // Every participant is gone, nobody holds a hazard
+    for (Retired& r : m_orphans) {
+      r.reclaimer->reclaim(&r.ptr, 1);
+    }
+    Record* rec = m_records.load(std::memory_order_acquire);
+    while (rec != nullptr) {
+      assert(!rec->inUse.load() && "domain destroyed with attached participants");
+      Record* next = rec->next;
+      delete rec;
+      rec = next;
+    }
+  }
+  HazardDomain(const HazardDomain&) = delete;
+  HazardDomain& operator=(const HazardDomain&) = delete;
+  // Rule of 5 end
+
+  Participant attach() {
+    return Participant{*this};
+  }
+  FenceMode mode() const {
+    return m_asymmetric ? FenceMode::Asymmetric : FenceMode::Symmetric;
+  }
+};
+
+/*
+Lock free unbounded MPMC queue (Michael & Scott) on hazard pointers, same push / try_pop as MRMWLockedStdQueue
+    - Head is a dummy node, pop protects head and head->next, the winner of the head CAS owns next's data
+    - Data is boxed so losers of the CAS never read a value the winner is moving out
+*/
+template<typename T>
+class MichaelScottQueue {
+  struct Node {
+    T* data{nullptr};
+    std::atomic<Node*> next{nullptr};
+  };
+  alignas(64) std::atomic<Node*> m_head;
+  alignas(64) std::atomic<Node*> m_tail;
+
+  void pushNode(Node* node, HazardDomain::Participant& participant) {
+    auto hp = participant.makeHazardPointer();
+    while (true) {
+      Node* tail = hp.protect(m_tail);
+      Node* next = tail->next.load(std::memory_order_acquire);
+      if (tail != m_tail.load(std::memory_order_acquire)) {
+        continue;
+      }
+      if (next != nullptr) {
+        m_tail.compare_exchange_weak(tail, next, std::memory_order_seq_cst); // Help a lagging tail
+        continue;
+      }
+      if (tail->next.compare_exchange_weak(next, node, std::memory_order_seq_cst)) {
+        m_tail.compare_exchange_strong(tail, node, std::memory_order_seq_cst);
+        return;
+      }
+    }
+  }
+public:
+  MichaelScottQueue() {
+    Node* dummy = new Node();
+    m_head.store(dummy, std::memory_order_relaxed);
+    m_tail.store(dummy, std::memory_order_relaxed);
+  }
+  // Rule of 5 : Disable Copy and Move
+  MichaelScottQueue(const MichaelScottQueue&) = delete;
+  MichaelScottQueue& operator=(const MichaelScottQueue&) = delete;
+  ~MichaelScottQueue() {
+    // Queue is quiescent : drain remaining nodes, the head dummy's data was already taken
+    Node* node = m_head.load(std::memory_order_relaxed);
+    bool dummy = true;
+    while (node != nullptr) {
+      Node* next = node->next.load(std::memory_order_relaxed);
+      if (!dummy) {
+        delete node->data;
+      }
+      delete node;
+      node = next;
+      dummy = false;
+    }
+  }
+  // Rule of 5 end
+
+  // writer calls
+  void push(const T& val, HazardDomain::Participant& participant) {
+    pushNode(new Node{new T(val)}, participant);
+  }
+  void push(T&& val, HazardDomain::Participant& participant) {
+    pushNode(new Node{new T(std::move(val))}, participant);
+  }
+
+  // reader calls
+  bool try_pop(T& val, HazardDomain::Participant& participant) {
+    auto hpHead = participant.makeHazardPointer();
+    auto hpNext = participant.makeHazardPointer();
+    while (true) {
+      Node* head = hpHead.protect(m_head);
+      Node* tail = m_tail.load(std::memory_order_acquire);
+      Node* next = head->next.load(std::memory_order_acquire);
+      if (next != nullptr && !hpNext.tryProtect(next, head->next)) {
+        continue;
+      }
+      if (head != m_head.load(std::memory_order_seq_cst)) {
+        continue; // next may belong to a retired head
+      }
+      if (next == nullptr) {
+        return false;
+      }
+      if (head == tail) {
+        m_tail.compare_exchange_weak(tail, next, std::memory_order_seq_cst);
+        continue;
+      }
+      T* data = next->data;
+      if (m_head.compare_exchange_weak(head, next, std::memory_order_seq_cst)) {
+        if constexpr (std::is_nothrow_move_assignable_v<T>) {
+          val = std::move(*data);
+        }
+        else {
+          val = *data;
+        }
+        delete data;
+        hpHead.reset();
+        participant.retire(head);
+        return true;
+      }
+    }
+  }
+};
+
+// Baseline : std::queue guarded by a mutex, the MRMWLockedStdQueue core without waiting
+template<typename T>
+class MutexQueue {
+  std::queue<T> m_queue;
+  std::mutex m_lock;
+public:
+  void push(const T& val, HazardDomain::Participant&) {
+    std::lock_guard<std::mutex> guard{m_lock};
+    m_queue.push(val);
+  }
+  bool try_pop(T& val, HazardDomain::Participant&) {
+    std::lock_guard<std::mutex> guard{m_lock};
+    if (m_queue.empty()) {
+      return false;
+    }
+    val = std::move(m_queue.front());
+    m_queue.pop();
+    return true;
+  }
+};
+
+/*
+WeakPtr::lock style upgrade : a slot publishes an object with an intrusive strong count,
+readers get a strong reference only if the count is still non zero.
+The hazard keeps the count's memory valid between reading the slot and the increment
+*/
+struct Session {
+  std::atomic<size_t> strong{1};
+  int id;
+  static inline std::atomic<int> destroyed{0};
+  explicit Session(int id_) : id{id_} {}
+  ~Session() {
+    id = -1;
+    destroyed++;
+  }
+  bool tryAcquire() {
+    size_t count = strong.load(std::memory_order_relaxed);
+    while (count != 0) {
+      if (strong.compare_exchange_weak(count, count + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    return false;
+  }
+  // Last reference retires instead of deleting : a reader may be about to look at the count
+  void release(HazardDomain::Participant& participant) {
+    if (strong.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      participant.retire(this);
+    }
+  }
+};
+
+Session* upgrade(const std::atomic<Session*>& slot, HazardDomain::Participant& participant) {
+  auto hp = participant.makeHazardPointer();
+  Session* session = hp.protect(slot);
+  if (session != nullptr && session->tryAcquire()) {
+    return session;
+  }
+  return nullptr;
+}
+
+// Producers push, consumers pop until every value arrived, sums must match
+template<template<typename> class QueueT>
+long long runQueue(HazardDomain& domain, size_t nProducers, size_t nConsumers, size_t nPerProducer) {
+  QueueT<size_t> queue;
+  std::atomic<size_t> consumed{0};
+  std::atomic<size_t> sum{0};
+  std::vector<std::thread> threads;
+  auto start = std::chrono::high_resolution_clock::now();
+  for (size_t p = 0; p < nProducers; p++) {
+    threads.emplace_back([&, p]() {
+      auto participant = domain.attach();
+      for (size_t i = 0; i < nPerProducer; i++) {
+        queue.push(p * nPerProducer + i, participant);
+      }
+    });
+  }
+  size_t total = nProducers * nPerProducer;
+  for (size_t c = 0; c < nConsumers; c++) {
+    threads.emplace_back([&]() {
+      auto participant = domain.attach();
+      size_t local = 0;
+      size_t val;
+      while (consumed.load(std::memory_order_relaxed) < total) {
+        if (queue.try_pop(val, participant)) {
+          local += val;
+          consumed++;
+        }
+      }
+      sum += local;
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  assert(sum == total * (total - 1) / 2);
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+// Reader side cost : hand over hand protected walk over a list, no writers
+long long benchmarkProtectWalk(HazardDomain& domain, size_t nNodes, size_t nWalks) {
+  struct Node {
+    std::atomic<Node*> next{nullptr};
+    size_t val{0};
+  };
+  std::vector<Node> nodes(nNodes);
+  for (size_t i = 0; i < nNodes; i++) {
+    nodes[i].val = i;
+    nodes[i].next.store(i + 1 < nNodes ? &nodes[i + 1] : nullptr, std::memory_order_relaxed);
+  }
+  std::atomic<Node*> head{&nodes[0]};
+  auto participant = domain.attach();
+  auto hpCur = participant.makeHazardPointer();
+  auto hpPrev = participant.makeHazardPointer();
+  size_t sum = 0;
+  auto start = std::chrono::high_resolution_clock::now();
+  for (size_t w = 0; w < nWalks; w++) {
+    Node* cur = hpCur.protect(head);
+    while (cur != nullptr) {
+      sum += cur->val;
+      hpPrev.resetProtection(cur);
+      cur = hpCur.protect(cur->next);
+    }
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  assert(sum == nWalks * nNodes * (nNodes - 1) / 2);
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+int main() {
+  HazardDomain symmetric{FenceMode::Symmetric, 8};
+  HazardDomain asymmetric{FenceMode::Asymmetric, 8};
+  std::cout << "membarrier " << (asymmetric.mode() == FenceMode::Asymmetric ? "available" : "unavailable, asymmetric falls back") << '\n';
+
+  for (HazardDomain* domain : {&symmetric, &asymmetric}) {
+    // Protected object survives scans, unprotected ones are freed
+    {
+      static std::atomic<int> freed{0};
+      struct Obj {
+        ~Obj() {
+          freed++;
+        }
+      };
+      freed = 0;
+      auto reader = domain->attach();
+      auto writer = domain->attach();
+      Obj* kept = new Obj();
+      std::atomic<Obj*> src{kept};
+      {
+        auto hp = reader.makeHazardPointer();
+        assert(hp.protect(src) == kept);
+        src.store(nullptr, std::memory_order_seq_cst);
+        writer.retire(kept);
+        for (int i = 0; i < 100; i++) {
+          writer.retire(new Obj());
+        }
+        writer.scan();
+        assert(writer.pendingCount() == 1 && freed == 100);
+      } // Hazard pointer released
+      writer.scan();
+      assert(writer.pendingCount() == 0 && freed == 101);
+    }
+    // Bounded garbage : a reader that sleeps on a hazard pins one object, not the whole retire stream
+    {
+      auto sleeper = domain->attach();
+      auto writer = domain->attach();
+      auto hp = sleeper.makeHazardPointer();
+      std::atomic<int*> src{new int(1)};
+      int* pinned = hp.protect(src);
+      src.store(nullptr, std::memory_order_seq_cst);
+      writer.retire(pinned);
+      size_t maxPending = 0;
+      for (int i = 0; i < 100'000; i++) {
+        writer.retire(new int(i));
+        maxPending = std::max(maxPending, writer.pendingCount());
+      }
+      assert(maxPending < writer.retireThreshold());
+      assert(*pinned == 1);
+      hp.reset();
+    }
+    // Orphans : a participant leaving with protected objects hands them to the domain
+    {
+      auto reader = domain->attach();
+      auto hp = reader.makeHazardPointer();
+      std::atomic<int*> src{new int(7)};
+      int* obj = hp.protect(src);
+      std::thread([domain, obj]() {
+        auto participant = domain->attach();
+        participant.retire(obj);
+      }).join();
+      assert(*obj == 7);
+      hp.reset();
+      reader.scan(); // adopts and frees the orphan
+      assert(reader.pendingCount() == 0);
+    }
+
+    // Queue : single thread FIFO
+    {
+      auto participant = domain->attach();
+      MichaelScottQueue<int> queue;
+      int val = 0;
+      assert(!queue.try_pop(val, participant));
+      for (int i = 0; i < 10; i++) {
+        queue.push(i, participant);
+      }
+      for (int i = 0; i < 5; i++) {
+        assert(queue.try_pop(val, participant) && val == i);
+      }
+    } // Leftover elements freed by the queue
+    runQueue<MichaelScottQueue>(*domain, 4, 4, 50'000);
+
+    // Upgrade stress : readers lock() sessions while a writer keeps replacing them
+    {
+      Session::destroyed = 0;
+      std::atomic<Session*> current{new Session(0)};
+      std::atomic<bool> stop{false};
+      std::vector<std::thread> readers;
+      for (int r = 0; r < 4; r++) {
+        readers.emplace_back([&]() {
+          auto participant = domain->attach();
+          while (!stop.load(std::memory_order_relaxed)) {
+            if (Session* s = upgrade(current, participant)) {
+              assert(s->id >= 0);
+              s->release(participant);
+            }
+          }
+        });
+      }
+      {
+        auto participant = domain->attach();
+        for (int i = 1; i <= 20'000; i++) {
+          Session* old = current.exchange(new Session(i), std::memory_order_seq_cst);
+          old->release(participant); // Slot's reference
+        }
+        stop = true;
+        for (auto& t : readers) {
+          t.join();
+        }
+        current.exchange(nullptr, std::memory_order_seq_cst)->release(participant);
+        participant.scan();
+      }
+      auto participant = domain->attach();
+      participant.scan(); // adopt whatever the readers left behind
+      assert(Session::destroyed == 20'001);
+    }
+  }
+
+  // Benchmark : reader side cost of a protect, symmetric vs asymmetric fences
+  {
+    size_t nNodes = 1 << 10;
+    size_t nWalks = 10'000;
+    std::cout << "Symmetric protected walk took " << benchmarkProtectWalk(symmetric, nNodes, nWalks) << " nanoseconds!\n";
+    std::cout << "Asymmetric protected walk took " << benchmarkProtectWalk(asymmetric, nNodes, nWalks) << " nanoseconds!\n";
+  }
+  // Benchmark : lock free queue vs mutex queue
+  for (size_t nThreads : {1, 2, 4}) {
+    size_t nPerProducer = 500'000;
+    std::cout << nThreads << " producers / consumers\n";
+    std::cout << "  MichaelScottQueue symmetric took " << runQueue<MichaelScottQueue>(symmetric, nThreads, nThreads, nPerProducer) << " nanoseconds!\n";
+    std::cout << "  MichaelScottQueue asymmetric took " << runQueue<MichaelScottQueue>(asymmetric, nThreads, nThreads, nPerProducer) << " nanoseconds!\n";
+    std::cout << "  MutexQueue took " << runQueue<MutexQueue>(symmetric, nThreads, nThreads, nPerProducer) << " nanoseconds!\n";
+  }
+}
@@ -1,13 +1,71 @@
+/*
+  Allocation statistics for MemoryPool, only compiled in when EnableStats is true
+    - live / peak live objects
+    - allocation rate since pool creation
+    - slab growth events (every call to resize)
+    - sampled call site tags to find which code paths churn the pool
+*/
+struct MemoryPoolStats {
+  using ClockT = std::chrono::steady_clock;
+
+  size_t totalAllocs{0};
+  size_t totalDeallocs{0};
+  size_t liveObjects{0};
+  size_t peakLiveObjects{0};
+  size_t slabGrowths{0};
+  size_t sampleRate{1}; // Record every sampleRate'th tagged allocation
+  ClockT::time_point start{ClockT::now()};
+  // call site tag -> sampled allocations, keyed on the text so equal tags from different literals / TUs add up
+  // tags are stored as views : pass string literals or other strings that outlive the pool
+  std::unordered_map<std::string_view, size_t> hotSites;
+
+  void onAlloc(const char* site) {
+    totalAllocs++;
+    liveObjects++;
+    peakLiveObjects = std::max(peakLiveObjects, liveObjects);
+    // Sampling keeps the map lookup off most allocations
+    if (site != nullptr && totalAllocs % sampleRate == 0) {
+      hotSites[site]++;
+    }
+  }
+  void onDealloc() {
+    totalDeallocs++;
+    liveObjects--;
+  }
+  void onGrowth() {
+    slabGrowths++;
+  }
+  double allocsPerSecond() const {
+    double secs = std::chrono::duration<double>(ClockT::now() - start).count();
+    return secs > 0 ? totalAllocs / secs : 0;
+  }
+  void report(std::ostream& os) const {
+    os << "MemoryPool stats: allocs=" << totalAllocs << " deallocs=" << totalDeallocs
+       << " live=" << liveObjects << " peak=" << peakLiveObjects
+       << " slabGrowths=" << slabGrowths << " allocs/s=" << allocsPerSecond() << '\n';
+    for (const auto& [site, count] : hotSites) {
+      os << "  " << site << " : " << count << " sampled allocs\n";
+    }
+  }
+};
+
+// Empty stand in for disabled builds, takes no space in MemoryPool due to [[no_unique_address]]
+struct MemoryPoolNoStats {};
+
 /*
   Implement Pool using new operator
+  EnableStats = false compiles out every stats hook, the pool is identical to the plain version
 */
-template<typename T>
+template<typename T, bool EnableStats = false>
 class MemoryPool {
+  using StatsT = std::conditional_t<EnableStats, MemoryPoolStats, MemoryPoolNoStats>;
+
   std::vector<T*> m_pool; // Stores available memory for allocation
   std::vector<void*> m_toFree; // Stores allocations to delete on Dtor
 
   size_t m_reallocSize{0}; // Stores reallocation size if pool runs out of mememory
   size_t m_numAllocated{0}; // Store the number of T for which memory is allocated
+  [[no_unique_address]] StatsT m_stats; // Stores allocation statistics if enabled
 
 public:
 
@@ -25,6 +83,13 @@ public:
   //Rule of 5 : Disable Copy / Move
   ~MemoryPool() {
     // When Dtor calls user needs to ensure that dealloc is called on each alloc, otherwise there will be a memory leak
+    // With stats enabled outstanding allocations are reported instead of going unnoticed
+    if constexpr (EnableStats) {
+      if (m_stats.liveObjects != 0) {
+        std::cerr << "MemoryPool leak: " << m_stats.liveObjects << " outstanding allocations at destruction\n";
+        m_stats.report(std::cerr);
+      }
+    }
     for (void* toFree : m_toFree) {
       ::operator delete[](toFree, std::align_val_t(alignof(T)));
     }
@@ -57,11 +122,15 @@ public:
   void resize(size_t nAllocations) {
     void* rawBytes = allocateRaw(nAllocations);
     addToPool(rawBytes, nAllocations);
+    if constexpr (EnableStats) {
+      m_stats.onGrowth();
+    }
   }
 
   // Returns address to construct object
   // this can leak if user does not handle throw on construction
-  T* alloc() {
+  // site : optional call site tag, sampled into hot site stats when enabled
+  T* alloc(const char* site = nullptr) {
     // Resize
     if (m_pool.empty()) {
       resize(m_reallocSize);
@@ -70,6 +139,9 @@ public:
     T* allocatePtr = m_pool.back();
     // Remove from pool
     m_pool.pop_back(); 
+    if constexpr (EnableStats) {
+      m_stats.onAlloc(site);
+    }
     return allocatePtr;
   }
 
@@ -77,6 +149,9 @@ public:
   void dealloc(T* ptr) {
     ptr->~T();
     m_pool.push_back(ptr);
+    if constexpr (EnableStats) {
+      m_stats.onDealloc();
+    }
   }
 
   // Function to construct T in place
@@ -90,6 +165,12 @@ public:
     static_assert(std::is_nothrow_constructible_v<T, ArgsT...>, "MemoryPool::make requires nothrow construction");
     return new (alloc()) T(std::forward<ArgsT>(args)...);
   }
+  // Same as make but tags the allocation with a call site
+  template<typename... ArgsT>
+  T* makeTagged(const char* site, ArgsT&&... args) {
+    static_assert(std::is_nothrow_constructible_v<T, ArgsT...>, "MemoryPool::make requires nothrow construction");
+    return new (alloc(site)) T(std::forward<ArgsT>(args)...);
+  }
 
   // Getters
   size_t allocated() const {
@@ -100,12 +181,44 @@ public:
     return m_pool.size();
   }
 
+  const MemoryPoolStats& stats() const requires EnableStats {
+    return m_stats;
+  }
+
   // Setters
   void adjustReallocSize(size_t size) {
     m_reallocSize = (size == 0 ? 1 : size);
   }
+  // Records every n'th tagged allocation in hot site stats
+  void setSampleRate(size_t n) requires EnableStats {
+    m_stats.sampleRate = (n == 0 ? 1 : n);
+  }
 };
 
+// Alloc / dealloc churn, returns nanoseconds taken
+template<bool Tagged, typename PoolT>
+long long benchmarkChurn(PoolT& pool, size_t nOps, size_t batch) {
+  std::vector<int*> live;
+  live.reserve(batch);
+  auto start = std::chrono::high_resolution_clock::now();
+  for (size_t i = 0; i < nOps; i += batch) {
+    for (size_t j = 0; j < batch; j++) {
+      if constexpr (Tagged) {
+        live.push_back(pool.makeTagged("benchmarkChurn", static_cast<int>(j)));
+      }
+      else {
+        live.push_back(pool.make(static_cast<int>(j)));
+      }
+    }
+    for (int* p : live) {
+      pool.dealloc(p);
+    }
+    live.clear();
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
 int main() {
   MemoryPool<int> pool{2};
   int* p1 = pool.make(125);
@@ -126,5 +239,48 @@ int main() {
   A* p4 = pool1.make();
   pool1.dealloc(p4);
 
+  // Stats
+  {
+    MemoryPool<int, true> statsPool{1, 2};
+    int* a = statsPool.makeTagged("site-a", 1);
+    int* b = statsPool.makeTagged("site-a", 2); // grows
+    int* c = statsPool.makeTagged("site-b", 3);
+    assert(statsPool.stats().peakLiveObjects == 3);
+    assert(statsPool.stats().slabGrowths == 1);
+    assert(statsPool.stats().hotSites.at("site-a") == 2);
+    statsPool.dealloc(a);
+    statsPool.dealloc(b);
+    assert(statsPool.stats().liveObjects == 1);
+    assert(statsPool.stats().peakLiveObjects == 3);
+    // Same text from a different buffer counts towards the same site
+    static const char otherSiteB[] = {'s', 'i', 't', 'e', '-', 'b', '\0'};
+    int* d = statsPool.makeTagged(otherSiteB, 4);
+    assert(statsPool.stats().hotSites.size() == 2 && statsPool.stats().hotSites.at("site-b") == 2);
+    statsPool.dealloc(d);
+    statsPool.stats().report(std::cout);
+    statsPool.dealloc(c);
+  }
+
+  // Disabled stats add no space : same layout as the pool before stats existed
+  struct PlainPoolLayout {
+    std::vector<int*> pool;
+    std::vector<void*> toFree;
+    size_t reallocSize;
+    size_t numAllocated;
+  };
+  static_assert(sizeof(MemoryPool<int, false>) == sizeof(PlainPoolLayout));
+  static_assert(sizeof(MemoryPool<double, false>) == 2 * sizeof(std::vector<void*>) + 2 * sizeof(size_t));
+
+  // Benchmark : with stats disabled a tag must cost nothing, untagged make is the plain pool's code path
+  {
+    size_t nOps = 1 << 24;
+    MemoryPool<int, false> plain{1 << 10};
+    MemoryPool<int, true> withStats{1 << 10};
+    withStats.setSampleRate(64);
+    std::cout << "stats disabled, untagged took " << benchmarkChurn<false>(plain, nOps, 1 << 10) << " nanoseconds!\n";
+    std::cout << "stats disabled, tagged took " << benchmarkChurn<true>(plain, nOps, 1 << 10) << " nanoseconds!\n";
+    std::cout << "stats enabled, tagged took " << benchmarkChurn<true>(withStats, nOps, 1 << 10) << " nanoseconds!\n";
+  }
+
 }
 
@@ -0,0 +1,372 @@
+#include<vector>
+#include<new>
+#include<cstdint>
+#include<limits>
+#include<algorithm>
+#include<string>
+#include<cassert>
+#include<utility>
+#include<random>
+#include<chrono>
+#include<iostream>
+#include<stdexcept>
+
+/*
+  Generational handle pool (slot map)
+    - Objects live densely in one contiguous array, iterating all live objects is a linear scan
+    - Users hold a Handle {index, generation} instead of a pointer
+    - Erase swaps the last object into the hole : O(1) and the array stays dense
+    - Each erase bumps the slot generation, so old handles are detected as stale instead of dangling
+
+  Growth follows MemoryPool : initial allocation + a reallocation size when we run out,
+  but since the storage must stay contiguous we grow to max(cap + reallocSize, 2 * cap)
+  and relocate, which keeps insert amortized O(1)
+
+  check: MonotonicAllocator.cpp for MemoryPool
+*/
+template<typename T>
+class SlotMap {
+public:
+  struct Handle {
+    uint32_t index{std::numeric_limits<uint32_t>::max()};
+    uint32_t generation{0};
+    friend bool operator==(const Handle& f, const Handle& s) {
+      return f.index == s.index && f.generation == s.generation;
+    }
+  };
+
+private:
+  struct Slot {
+    uint32_t denseIdx{0}; // Position of object in dense array if live, next free slot otherwise
+    uint32_t generation{0};
+  };
+  static constexpr uint32_t NO_FREE_SLOT = std::numeric_limits<uint32_t>::max();
+
+  T* m_dense{nullptr}; // Stores objects contiguously
+  std::vector<uint32_t> m_denseToSlot; // Stores slot index for each object, needed to fix slot on swap remove
+  std::vector<Slot> m_slots; // Stores handle index -> dense position
+  uint32_t m_freeHead{NO_FREE_SLOT}; // Head of free slot list threaded through Slot::denseIdx
+
+  size_t m_size{0};
+  size_t m_cap{0};
+  size_t m_reallocSize{0}; // Stores minimum growth if map runs out of memory
+
+  void* allocateRaw(size_t nAllocations) {
+    // Get Raw Bytes with Alignment
+    return ::operator new[](nAllocations * sizeof(T), std::align_val_t(alignof(T)));
+  }
+
+  void freeRaw(T* ptr) {
+    ::operator delete[](ptr, std::align_val_t(alignof(T)));
+  }
+
+  // Moves live objects into newDense and adopts it, a throwing copy leaves the map unchanged
+  void relocate(T* newDense, size_t newCap) {
+    size_t i = 0;
+    try {
+      for (; i < m_size; i++) {
+        new (newDense + i) T(std::move_if_noexcept(m_dense[i]));
+      }
+    }
+    catch(...) {
+      for (size_t j = 0; j < i; j++) {
+        (newDense + j)->~T();
+      }
+      throw;
+    }
+    // Destroy
+    for (size_t i = 0; i < m_size; i++) {
+      (m_dense + i)->~T();
+    }
+    freeRaw(m_dense);
+    m_dense = newDense;
+    m_cap = newCap;
+  }
+
+  void increaseCapacity(size_t newCap) {
+    assert(newCap >= m_cap);
+    m_denseToSlot.reserve(newCap);
+    T* newDense = reinterpret_cast<T*>(allocateRaw(newCap));
+    try {
+      relocate(newDense, newCap);
+    }
+    catch(...) {
+      freeRaw(newDense);
+      throw;
+    }
+  }
+
+  // Reserves bookkeeping for one more object, so committing an insert can not throw
+  void reserveBookkeeping() {
+    if (m_freeHead == NO_FREE_SLOT && m_slots.size() == m_slots.capacity()) {
+      m_slots.reserve(std::max<size_t>(m_slots.size() * 2, 16));
+    }
+    if (m_denseToSlot.size() == m_denseToSlot.capacity()) {
+      m_denseToSlot.reserve(std::max<size_t>(m_cap, m_denseToSlot.size() + 1));
+    }
+  }
+
+  // Returns slot for a live handle, nullptr if handle is stale
+  const Slot* find(Handle h) const {
+    if (h.index >= m_slots.size()) {
+      return nullptr;
+    }
+    const Slot& slot = m_slots[h.index];
+    // Generation is odd while the slot is live, erase makes it even again
+    if (slot.generation != h.generation || (slot.generation & 1) == 0) {
+      return nullptr;
+    }
+    return &slot;
+  }
+
+  uint32_t acquireSlot() {
+    if (m_freeHead != NO_FREE_SLOT) {
+      uint32_t idx = m_freeHead;
+      m_freeHead = m_slots[idx].denseIdx;
+      return idx;
+    }
+    m_slots.push_back(Slot{});
+    return static_cast<uint32_t>(m_slots.size() - 1);
+  }
+
+public:
+  explicit SlotMap(size_t nAllocations = 0, size_t nReAllocSize = 1<<8) {
+    m_reallocSize = std::max<size_t>(nReAllocSize, 1);
+    if (nAllocations != 0) {
+      increaseCapacity(nAllocations);
+      m_slots.reserve(nAllocations);
+    }
+  }
+
+  //Rule of 5 : Disable Copy / Move
+  ~SlotMap() {
+    clear();
+    freeRaw(m_dense);
+  }
+  SlotMap(const SlotMap&) = delete;
+  SlotMap& operator=(const SlotMap&) = delete;
+  // Rule of 5 end
+
+  template<typename... ArgsT>
+  Handle emplace(ArgsT&&... args) {
+    // Reserve, then construct, then commit with steps that can not throw : a throwing Ctor leaves the map untouched
+    reserveBookkeeping();
+    if (m_size == m_cap) {
+      // args may refer to an object in the map : construct into the new buffer before relocating the old one
+      size_t newCap = std::max(m_cap + m_reallocSize, m_cap << 1);
+      m_denseToSlot.reserve(newCap);
+      T* newDense = reinterpret_cast<T*>(allocateRaw(newCap));
+      try {
+        new (newDense + m_size) T(std::forward<ArgsT>(args)...);
+      }
+      catch(...) {
+        freeRaw(newDense);
+        throw;
+      }
+      try {
+        relocate(newDense, newCap);
+      }
+      catch(...) {
+        (newDense + m_size)->~T();
+        freeRaw(newDense);
+        throw;
+      }
+    }
+    else {
+      new (m_dense + m_size) T(std::forward<ArgsT>(args)...);
+    }
+    uint32_t slotIdx = acquireSlot();
+    Slot& slot = m_slots[slotIdx];
+    slot.denseIdx = static_cast<uint32_t>(m_size);
+    slot.generation++; // even -> odd : live
+    m_denseToSlot.push_back(slotIdx);
+    m_size++;
+    return Handle{slotIdx, slot.generation};
+  }
+  Handle insert(const T& val) {
+    return emplace(val);
+  }
+  Handle insert(T&& val) {
+    return emplace(std::move(val));
+  }
+
+  // Returns false if handle is stale
+  bool erase(Handle h) {
+    if (find(h) == nullptr) {
+      return false;
+    }
+    Slot& slot = m_slots[h.index];
+    size_t idx = slot.denseIdx;
+    size_t last = m_size - 1;
+    // Swap remove : move last object into the hole and repoint its slot
+    if (idx != last) {
+      m_dense[idx] = std::move(m_dense[last]);
+      m_denseToSlot[idx] = m_denseToSlot[last];
+      m_slots[m_denseToSlot[idx]].denseIdx = static_cast<uint32_t>(idx);
+    }
+    (m_dense + last)->~T();
+    m_denseToSlot.pop_back();
+    m_size--;
+    // Invalidate handle and put slot on free list
+    slot.generation++; // odd -> even : dead
+    slot.denseIdx = m_freeHead;
+    m_freeHead = h.index;
+    return true;
+  }
+
+  // Returns nullptr if handle is stale
+  T* get(Handle h) {
+    const Slot* slot = find(h);
+    return slot ? m_dense + slot->denseIdx : nullptr;
+  }
+  const T* get(Handle h) const {
+    const Slot* slot = find(h);
+    return slot ? m_dense + slot->denseIdx : nullptr;
+  }
+  bool contains(Handle h) const {
+    return find(h) != nullptr;
+  }
+
+  // Destroys all objects, every outstanding handle becomes stale
+  void clear() {
+    while (m_size != 0) {
+      uint32_t slotIdx = m_denseToSlot[m_size - 1];
+      erase(Handle{slotIdx, m_slots[slotIdx].generation});
+    }
+  }
+
+  // Dense iteration : order changes on erase
+  T* begin() { return m_dense; }
+  T* end() { return m_dense + m_size; }
+  const T* begin() const { return m_dense; }
+  const T* end() const { return m_dense + m_size; }
+
+  size_t size() const { return m_size; }
+  size_t capacity() const { return m_cap; }
+  bool empty() const { return m_size == 0; }
+
+  // Setters
+  void adjustReallocSize(size_t size) {
+    m_reallocSize = (size == 0 ? 1 : size);
+  }
+};
+
+int main() {
+  {
+    SlotMap<int> map{2, 2};
+    auto h1 = map.insert(1);
+    auto h2 = map.insert(2);
+    auto h3 = map.insert(3); // grows
+    assert(map.size() == 3);
+    assert(*map.get(h1) == 1 && *map.get(h2) == 2 && *map.get(h3) == 3);
+
+    assert(map.erase(h1));
+    assert(!map.contains(h1));
+    assert(map.get(h1) == nullptr);
+    assert(!map.erase(h1)); // double erase detected
+    assert(*map.get(h3) == 3); // swapped into the hole
+
+    auto h4 = map.insert(4); // reuses h1's slot with a new generation
+    assert(h4.index == h1.index);
+    assert(!(h4 == h1));
+    assert(map.get(h1) == nullptr);
+    assert(*map.get(h4) == 4);
+
+    int sum = 0;
+    for (int x : map) {
+      sum += x;
+    }
+    assert(sum == 9);
+
+    map.clear();
+    assert(map.empty() && !map.contains(h2));
+  }
+
+  {
+    SlotMap<std::string> names;
+    auto h = names.emplace("a string long enough to not fit in sso buffer");
+    names.emplace("b");
+    names.erase(h);
+    assert(*names.begin() == "b");
+
+    // Inserting a copy of an object in the map while it grows
+    SlotMap<std::string> copies{1, 1};
+    auto first = copies.emplace("a string long enough to not fit in sso buffer");
+    auto second = copies.insert(*copies.get(first));
+    assert(copies.capacity() == 2 && *copies.get(second) == *copies.get(first));
+  }
+
+  // Throwing Ctor leaves the map untouched
+  {
+    struct Throws {
+      int val;
+      explicit Throws(int val_) : val{val_} {
+        if (val_ < 0) throw std::runtime_error("negative");
+      }
+    };
+    SlotMap<Throws> map{1, 1};
+    auto h = map.emplace(1);
+    for (int i = 0; i < 2; i++) { // map is full : both rounds throw while growing
+      bool caught = false;
+      try {
+        map.emplace(-1);
+      }
+      catch (const std::runtime_error&) {
+        caught = true;
+      }
+      assert(caught && map.size() == 1 && map.get(h)->val == 1);
+    }
+    auto h2 = map.emplace(2);
+    assert(h2.index == 1 && map.size() == 2); // no slot was burned by the failed emplaces
+  }
+
+  // Benchmark : iterate live objects after churn, slot map vs scattered heap pointers
+  {
+    struct Entity { double x, y, vx, vy; };
+    size_t n = 1'000'000;
+    std::mt19937 rng{42};
+
+    SlotMap<Entity> map{n};
+    std::vector<SlotMap<Entity>::Handle> handles;
+    std::vector<Entity*> ptrs;
+    handles.reserve(n);
+    ptrs.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+      handles.push_back(map.insert(Entity{double(i), 0, 1, 1}));
+      ptrs.push_back(new Entity{double(i), 0, 1, 1});
+    }
+    // Churn : erase and reinsert random half so heap objects get scattered
+    std::shuffle(ptrs.begin(), ptrs.end(), rng);
+    std::shuffle(handles.begin(), handles.end(), rng);
+    for (size_t i = 0; i < n / 2; i++) {
+      map.erase(handles[i]);
+      handles[i] = map.insert(Entity{double(i), 0, 1, 1});
+      delete ptrs[i];
+      ptrs[i] = new Entity{double(i), 0, 1, 1};
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int rep = 0; rep < 10; rep++) {
+      for (Entity& e : map) {
+        e.x += e.vx;
+        e.y += e.vy;
+      }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::cout << "SlotMap dense iteration took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+
+    start = std::chrono::high_resolution_clock::now();
+    for (int rep = 0; rep < 10; rep++) {
+      for (Entity* e : ptrs) {
+        e->x += e->vx;
+        e->y += e->vy;
+      }
+    }
+    end = std::chrono::high_resolution_clock::now();
+    std::cout << "Pointer chasing took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+
+    for (Entity* e : ptrs) {
+      delete e;
+    }
+  }
+}
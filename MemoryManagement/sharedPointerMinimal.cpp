@@ -1,41 +1,99 @@
-
+#include<iostream>
+#include<cassert>
+#include<atomic>
+#include<new>
+#include<utility>
+#include<vector>
+#include<thread>
+#include<memory>
+#include<chrono>
+#include<cstdlib>
 
 /*
 Implement shared ptr
-pending: weak ptr / thread safety / alloc
+pending: weak ptr / custom allocator
+
+Thread safety : reference count is atomic, distinct SharedPtr objects pointing to the same
+object can be copied / destroyed from any thread (one SharedPtr object itself is not thread safe)
+    - increment is relaxed : a new reference is made from an existing one, nothing to order
+    - decrement is release, and the thread dropping the last reference does an acquire load
+      before destroying, so every other owner's writes to the object happen before the Dtor
+makeShared<T>(args...) allocates the count and the object in one block (one allocation,
+count and object share cache lines)
 
 check: singlethreadedsharedweakptr.cpp for single threaded shared weak ptr
 */
 
+// Control block : owns the object, dispose() destroys the object and the block
+struct ControlBlockBase {
+  std::atomic<size_t> refCount{1};
+  void increment() noexcept {
+    refCount.fetch_add(1, std::memory_order_relaxed);
+  }
+  // Returns true if this was the last reference
+  bool decrement() noexcept {
+    if (refCount.fetch_sub(1, std::memory_order_release) == 1) {
+      // Acquire load of our own 0 syncs with every earlier release decrement (same as a fence, visible to TSAN)
+      (void)refCount.load(std::memory_order_acquire);
+      return true;
+    }
+    return false;
+  }
+  size_t getRefCount() const noexcept {
+    return refCount.load(std::memory_order_relaxed);
+  }
+  virtual void dispose() noexcept = 0;
+protected:
+  ~ControlBlockBase() = default;
+};
+
+// Object allocated separately, SharedPtr(new T)
+template<typename T>
+struct ControlBlockPtr final : ControlBlockBase {
+  T* ptr;
+  explicit ControlBlockPtr(T* ptr_) : ptr{ptr_} {}
+  void dispose() noexcept override {
+    delete ptr;
+    delete this;
+  }
+};
 
+// Object lives inside the block, makeShared
+template<typename T>
+struct ControlBlockInplace final : ControlBlockBase {
+  alignas(T) unsigned char storage[sizeof(T)];
+  template<typename... ArgsT>
+  explicit ControlBlockInplace(ArgsT&&... args) {
+    new (storage) T(std::forward<ArgsT>(args)...);
+  }
+  T* get() noexcept {
+    return std::launder(reinterpret_cast<T*>(storage));
+  }
+  void dispose() noexcept override {
+    get()->~T();
+    delete this;
+  }
+};
 
 template<typename T>
 class SharedPtr {
 public:
   using DataType = T;
 private:
-  struct ControlBlock {
-    size_t refCount{1};
-    void increment() {
-      refCount++;
-    }
-    void decrement() {
-      refCount--;
-    }
-    size_t getRefCount() const {
-      return refCount;
-    }
-  };
+  using ControlBlock = ControlBlockBase;
   DataType* m_ptr{nullptr};
   ControlBlock* m_controlBlockPtr{nullptr};
 
+  template<typename U, typename... ArgsT>
+  friend SharedPtr<U> makeShared(ArgsT&&... args);
+  // Adopts a block that already holds one reference
+  SharedPtr(DataType* ptr, ControlBlock* controlBlockPtr) noexcept : m_ptr{ptr}, m_controlBlockPtr{controlBlockPtr} {}
+
   // Release Ownership
   void release() noexcept {
     if (m_controlBlockPtr == nullptr) return;
-    m_controlBlockPtr->decrement();
-    if (m_controlBlockPtr->getRefCount() == 0) {
-      delete m_ptr;
-      delete m_controlBlockPtr;     
+    if (m_controlBlockPtr->decrement()) {
+      m_controlBlockPtr->dispose();
     }
     m_ptr = nullptr;
     m_controlBlockPtr = nullptr;
@@ -49,7 +107,7 @@ public:
     if (rawPtr == nullptr) return;
     // Guarantee that resource is released if ctor throw
     try {
-      m_controlBlockPtr = new ControlBlock;
+      m_controlBlockPtr = new ControlBlockPtr<DataType>(rawPtr);
     }
     catch(...) {
       delete rawPtr;
@@ -113,7 +171,7 @@ public:
     // Allocate memory first, then release ownership as new can throw
     ControlBlock* newControlBlockptr = nullptr;
     try {
-      newControlBlockptr = new ControlBlock;
+      newControlBlockptr = new ControlBlockPtr<DataType>(rawPtr);
     }
     catch(...) {
       delete rawPtr;
@@ -152,6 +210,58 @@ public:
 
 };
 
+// One allocation for count + object, T is constructed in place
+template<typename T, typename... ArgsT>
+SharedPtr<T> makeShared(ArgsT&&... args) {
+  auto* controlBlockPtr = new ControlBlockInplace<T>(std::forward<ArgsT>(args)...);
+  return SharedPtr<T>(controlBlockPtr->get(), controlBlockPtr);
+}
+
+// Counts global allocations to check makeShared does one
+std::atomic<size_t> g_numAllocations{0};
+// noinline : keeps GCC from seeing malloc / free behind new / delete (-Wmismatched-new-delete)
+__attribute__((noinline)) void* operator new(size_t size) {
+  g_numAllocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+__attribute__((noinline)) void operator delete(void* p) noexcept {
+  std::free(p);
+}
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept {
+  std::free(p);
+}
+
+// Copy / destroy churn : every thread copies a pointer and drops it again
+template<typename PtrT>
+void benchmarkChurn(const char* name, const PtrT& shared, size_t nThreads, size_t nCopies, bool contended) {
+  std::vector<PtrT> sources(nThreads, shared);
+  if (!contended) {
+    // Each thread gets its own object : counters don't share a cache line
+    for (auto& src : sources) {
+      src = PtrT(new int(0));
+    }
+  }
+  std::vector<std::thread> threads;
+  auto start = std::chrono::high_resolution_clock::now();
+  for (size_t t = 0; t < nThreads; t++) {
+    threads.emplace_back([&sources, t, nCopies]() {
+      for (size_t i = 0; i < nCopies; i++) {
+        PtrT copy{sources[t]};
+        assert(copy);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  std::cout << name << (contended ? " shared object, " : " private objects, ") << nThreads << " threads took "
+            << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+}
+
 int main() {
   struct A {
     A() {
@@ -184,4 +294,77 @@ int main() {
   assert(move.getUsedCount() == 1);
   move = std::move(s4);
   assert(move.getUsedCount() == 2);
+
+  // makeShared : one allocation, object sits in the block
+  {
+    struct Point {
+      double x, y;
+      Point(double x_, double y_) : x{x_}, y{y_} {}
+    };
+    size_t before = g_numAllocations;
+    SharedPtr<Point> p = makeShared<Point>(1.0, 2.0);
+    assert(g_numAllocations - before == 1);
+    assert(p->x == 1.0 && p.getUsedCount() == 1);
+    SharedPtr<Point> q{p};
+    assert(q.getUsedCount() == 2 && q.get() == p.get());
+    before = g_numAllocations;
+    SharedPtr<Point> r{new Point(3.0, 4.0)};
+    assert(g_numAllocations - before == 2);
+  }
+
+  // Threads copy / drop the same object, it must be destroyed exactly once
+  {
+    static std::atomic<int> destroyed{0};
+    struct Counted {
+      std::atomic<int> touched{0};
+      ~Counted() {
+        destroyed++;
+      }
+    };
+    {
+      SharedPtr<Counted> root = makeShared<Counted>();
+      std::vector<std::thread> threads;
+      for (int t = 0; t < 8; t++) {
+        threads.emplace_back([root]() mutable {
+          for (int i = 0; i < 100'000; i++) {
+            SharedPtr<Counted> copy{root};
+            copy->touched.fetch_add(1, std::memory_order_relaxed);
+            SharedPtr<Counted> moved{std::move(copy)};
+            moved.reset();
+          }
+        });
+      }
+      for (auto& t : threads) {
+        t.join();
+      }
+      assert(root.getUsedCount() == 1 && root->touched == 800'000 && destroyed == 0);
+    }
+    assert(destroyed == 1);
+  }
+
+  // Benchmark : copy / destroy churn, SharedPtr vs std::shared_ptr
+  {
+    size_t nCopies = 1'000'000;
+    SharedPtr<int> mine = makeShared<int>(0);
+    std::shared_ptr<int> theirs = std::make_shared<int>(0);
+    for (size_t nThreads : {1, 2, 4, 8, 16}) {
+      benchmarkChurn("SharedPtr", mine, nThreads, nCopies, true);
+      benchmarkChurn("std::shared_ptr", theirs, nThreads, nCopies, true);
+      benchmarkChurn("SharedPtr", mine, nThreads, nCopies, false);
+    }
+
+    size_t nObjects = 1'000'000;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < nObjects; i++) {
+      SharedPtr<int> p{new int(static_cast<int>(i))};
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::cout << "SharedPtr(new T) create / destroy took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+    start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < nObjects; i++) {
+      SharedPtr<int> p = makeShared<int>(static_cast<int>(i));
+    }
+    end = std::chrono::high_resolution_clock::now();
+    std::cout << "makeShared create / destroy took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+  }
 }
@@ -1,30 +1,120 @@
+#include<iostream>
+#include<cassert>
+#include<atomic>
+#include<thread>
+#include<mutex>
+#include<vector>
+#include<memory>
+#include<chrono>
+#include<cstdint>
+#include<algorithm>
+#include<new>
+#include<random>
+#include<numeric>
+#include<stdexcept>
+
 /*
 Implement shared ptr
+
+RefCountMode picks how the control block counts:
+    - SingleThreaded : plain counters, no thread safety
+    - Atomic : every copy / drop is an atomic RMW, usable from any thread
+    - Biased : the thread that created the object (owner) counts in a counter only it writes,
+      other threads use an atomic shared counter. Copies on the owner thread cost a plain load / store.
+      Merge protocol :
+        - owner's biased count reaching 0 sets the MERGED bit in the shared counter, from then on all
+          threads count atomically and whoever drops the shared count to 0 destroys
+        - a non owner that would drive the shared count below 0 (it drops a reference the owner counted)
+          hands that reference to the owner's queue instead, the owner folds its biased count into the shared
+          one when it drains its queue : drainBiasedRefCounts() at safe points, on creating a new object, and at thread exit
+        - the queue holds a reference so a queued block can not die before the owner drains it
+        - at thread exit the owner merges every block it still counts, blocks queued after that are released inline
+Atomic / Biased blocks count weak references atomically, all strong references together hold one weak
+reference so the block is freed exactly once by whoever drops the last weak
+
+makeShared<T, Mode>(args...) : inplace block, T is constructed right behind the block in the same allocation
+    - one allocation instead of two, deref touches the block's cache lines only
+    - T is destroyed when the strong count hits 0, the memory (block + T's bytes) stays until the last weak goes
 */
-template<typename T>
+enum class RefCountMode {
+  SingleThreaded,
+  Atomic,
+  Biased
+};
+
+// Marks a block whose object lives in the same allocation, right behind it
+struct InplaceTag {};
+
+// Layout of an inplace allocation : [block][padding][T]
+template<typename BlockT>
+struct InplaceLayout {
+  using ObjectT = typename BlockT::ObjectT;
+  static constexpr size_t OBJECT_OFFSET = (sizeof(BlockT) + alignof(ObjectT) - 1) / alignof(ObjectT) * alignof(ObjectT);
+  static constexpr size_t SIZE = OBJECT_OFFSET + sizeof(ObjectT);
+  static constexpr std::align_val_t ALIGN{std::max(alignof(BlockT), alignof(ObjectT))};
+};
+
+// Frees a block once its last weak reference is gone, object is already destroyed
+template<typename BlockT>
+void destroyControlBlock(BlockT* block) noexcept {
+  if (block->inplace()) {
+    block->~BlockT();
+    ::operator delete(static_cast<void*>(block), InplaceLayout<BlockT>::ALIGN);
+  }
+  else {
+    delete block;
+  }
+}
+
+template<typename T, RefCountMode Mode = RefCountMode::SingleThreaded>
 struct ControlBlock {
 private:
   size_t m_strongCount{0};
   size_t m_weakCount{0};
   T* m_ptr{nullptr};
+  bool m_inplace{false};
+  bool dead() const {
+    return (m_strongCount == 0 && m_weakCount == 0);
+  }
+  void disposeObject() {
+    if (m_inplace) {
+      m_ptr->~T();
+    }
+    else {
+      delete m_ptr;
+    }
+  }
 public:
+  using ObjectT = T;
   ControlBlock() = default;
   explicit ControlBlock(T* rawPtr) : m_ptr{rawPtr} {}
+  ControlBlock(T* objectPtr, InplaceTag) : m_ptr{objectPtr}, m_inplace{true} {}
   void acquireStrong() {
     m_strongCount++;
   }
-  void releaseStrong() {
+  // Returns true if the block should be deleted
+  bool releaseStrong() {
     m_strongCount--;
     if (m_strongCount == 0) {
-      delete m_ptr;
+      disposeObject();
       m_ptr = nullptr;
     }
+    return dead();
+  }
+  // Acquire only if object is alive, used by WeakPtr::lock
+  bool tryAcquireStrong() {
+    if (m_strongCount == 0) {
+      return false;
+    }
+    m_strongCount++;
+    return true;
   }
   void acquireWeak() {
     m_weakCount++;
   }
-  void releaseWeak() {
+  bool releaseWeak() {
     m_weakCount--;
+    return dead();
   }
   size_t getUsedCount() const {
     return m_strongCount;
@@ -32,16 +122,16 @@ public:
   size_t getWeakCount() const {
     return m_weakCount;
   }
-  bool dead() const {
-    return (m_strongCount == 0 && m_weakCount == 0);
-  }
   T* get() const {
     return m_ptr;
   }
-  // Rule of 5: 
+  bool inplace() const {
+    return m_inplace;
+  }
+  // Rule of 5:
   ~ControlBlock() {
     if (m_ptr != nullptr) {
-      delete m_ptr;
+      disposeObject();
     }
   }
   ControlBlock(const ControlBlock&) = delete;
@@ -49,25 +139,345 @@ public:
   // Rule of 5 end
 };
 
+// Weak count shared by Atomic / Biased blocks : strong references together hold one weak reference
+struct AtomicWeakCount {
+  std::atomic<size_t> weakCount{1};
+  void acquireWeak() {
+    weakCount.fetch_add(1, std::memory_order_relaxed);
+  }
+  // Returns true if the block should be deleted
+  bool releaseWeak() {
+    if (weakCount.fetch_sub(1, std::memory_order_release) == 1) {
+      (void)weakCount.load(std::memory_order_acquire); // syncs with every earlier release
+      return true;
+    }
+    return false;
+  }
+  size_t weakCountExcludingStrong(bool alive) const {
+    return weakCount.load(std::memory_order_relaxed) - (alive ? 1 : 0);
+  }
+};
+
 template<typename T>
-class WeakPtr;
+struct ControlBlock<T, RefCountMode::Atomic> : AtomicWeakCount {
+private:
+  std::atomic<size_t> m_strongCount{0};
+  T* m_ptr{nullptr}; // Not cleared on destroy : WeakPtr checks expired() instead
+  bool m_inplace{false};
+public:
+  using ObjectT = T;
+  explicit ControlBlock(T* rawPtr) : m_ptr{rawPtr} {}
+  ControlBlock(T* objectPtr, InplaceTag) : m_ptr{objectPtr}, m_inplace{true} {}
+  void acquireStrong(size_t n = 1) {
+    m_strongCount.fetch_add(n, std::memory_order_relaxed);
+  }
+  bool releaseStrong() {
+    if (m_strongCount.fetch_sub(1, std::memory_order_release) == 1) {
+      (void)m_strongCount.load(std::memory_order_acquire);
+      if (m_inplace) {
+        m_ptr->~T();
+      }
+      else {
+        delete m_ptr;
+      }
+      return releaseWeak();
+    }
+    return false;
+  }
+  bool tryAcquireStrong() {
+    size_t count = m_strongCount.load(std::memory_order_relaxed);
+    while (count != 0) {
+      if (m_strongCount.compare_exchange_weak(count, count + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    return false;
+  }
+  size_t getUsedCount() const {
+    return m_strongCount.load(std::memory_order_relaxed);
+  }
+  size_t getWeakCount() const {
+    return weakCountExcludingStrong(getUsedCount() != 0);
+  }
+  T* get() const {
+    return m_ptr;
+  }
+  bool inplace() const {
+    return m_inplace;
+  }
+  ControlBlock(const ControlBlock&) = delete;
+  ControlBlock& operator=(const ControlBlock&) = delete;
+};
+
+// Address of a thread local : cheaper owner check than std::this_thread::get_id()
+inline const void* currentThreadTag() {
+  thread_local char tag;
+  return &tag;
+}
+
+// Type erased part of a biased block, what the owner's merge queue holds
+struct BiasedCountBase : AtomicWeakCount {
+  static constexpr int64_t MERGED = 1; // Low bit of m_shared, count is in the upper bits (units of 2)
+  static constexpr int64_t ONE = 2;
+
+  const void* const m_owner{currentThreadTag()};
+  std::atomic<int64_t> m_biased{0}; // Written only by owner, atomic so other threads may read it for stats
+  bool m_ownerMerged{false}; // Owner only
+  std::atomic<int64_t> m_shared{0};
+  std::atomic<bool> m_queued{false};
+  // Owner only : links in the owner's list of unmerged blocks
+  BiasedCountBase* m_prevOwned{nullptr};
+  BiasedCountBase* m_nextOwned{nullptr};
+
+  // Owner thread's unmerged blocks, merged at thread exit so none is left waiting on a dead owner
+  static BiasedCountBase*& ownedHead() {
+    thread_local BiasedCountBase* head{nullptr};
+    return head;
+  }
+  BiasedCountBase() {
+    m_nextOwned = ownedHead();
+    if (m_nextOwned != nullptr) {
+      m_nextOwned->m_prevOwned = this;
+    }
+    ownedHead() = this;
+  }
+  void unlinkOwned() {
+    if (m_prevOwned != nullptr) {
+      m_prevOwned->m_nextOwned = m_nextOwned;
+    }
+    else {
+      ownedHead() = m_nextOwned;
+    }
+    if (m_nextOwned != nullptr) {
+      m_nextOwned->m_prevOwned = m_prevOwned;
+    }
+  }
+
+  // Owner check first : non owners must not read m_ownerMerged, the owner writes it while merging
+  bool onOwnerFastPath() const {
+    return currentThreadTag() == m_owner && !m_ownerMerged;
+  }
+  // Strong count reached zero for good : destroy object, drop the strong group's weak reference
+  void strongZero() {
+    destroyObject();
+    if (releaseWeak()) {
+      deleteSelf();
+    }
+  }
+  void releaseShared() {
+    int64_t old = m_shared.load(std::memory_order_relaxed);
+    while (true) {
+      if (!(old & MERGED) && (old >> 1) <= 0 && !m_queued.load(std::memory_order_relaxed)
+          && !m_queued.exchange(true, std::memory_order_relaxed)) {
+        // Dropping a reference the owner counted : the queue takes it over, the shared count never
+        // dips below the true total so a concurrent merge can not see a transient zero
+        queueToOwner();
+        return;
+      }
+      // Unmerged counts only go negative once the block is queued, the owner's merge settles them
+      if (m_shared.compare_exchange_weak(old, old - ONE, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+        break;
+      }
+    }
+    if ((old & MERGED) && (old >> 1) - 1 == 0) {
+      strongZero();
+    }
+  }
+  // Owner only : fold biased count into shared counter
+  void merge() {
+    if (m_ownerMerged) return;
+    m_ownerMerged = true;
+    unlinkOwned();
+    int64_t biased = m_biased.load(std::memory_order_relaxed);
+    m_biased.store(0, std::memory_order_relaxed);
+    int64_t old = m_shared.fetch_add(biased * ONE + MERGED, std::memory_order_acq_rel);
+    if ((old >> 1) + biased == 0) {
+      strongZero();
+    }
+  }
+
+  virtual void destroyObject() noexcept = 0;
+  virtual void deleteSelf() noexcept = 0;
+  virtual void queueToOwner() = 0;
+protected:
+  ~BiasedCountBase() {
+    // Only a block whose Ctor threw dies unmerged, that happens on the owner thread
+    if (!m_ownerMerged) {
+      unlinkOwned();
+    }
+  }
+};
+
+// Blocks a non owner sent back, drained by the owner thread
+struct BiasedMergeQueue {
+  std::mutex lock;
+  std::vector<BiasedCountBase*> pending;
+  std::atomic<bool> hasPending{false};
+  bool orphaned{false}; // Owner thread exited, guarded by lock
+
+  void push(BiasedCountBase* block) {
+    {
+      std::lock_guard<std::mutex> guard{lock};
+      if (!orphaned) {
+        pending.push_back(block);
+        hasPending.store(true, std::memory_order_release);
+        return;
+      }
+    }
+    // Owner merged the block before it exited : drop the queue's reference right here
+    block->releaseShared();
+  }
+  void drain() {
+    std::vector<BiasedCountBase*> blocks;
+    {
+      std::lock_guard<std::mutex> guard{lock};
+      blocks.swap(pending);
+      hasPending.store(false, std::memory_order_relaxed);
+    }
+    for (BiasedCountBase* block : blocks) {
+      block->merge();
+      block->releaseShared(); // queue's reference
+    }
+  }
+  // Owner thread exit : merge every block it still counts, later pushes release inline
+  void orphan() {
+    drain();
+    while (BiasedCountBase* block = BiasedCountBase::ownedHead()) {
+      block->merge();
+    }
+    {
+      std::lock_guard<std::mutex> guard{lock};
+      orphaned = true;
+    }
+    drain();
+  }
+};
+
+// Per thread queue, orphaned when the thread exits
+struct BiasedMergeQueueHolder {
+  std::shared_ptr<BiasedMergeQueue> queue{std::make_shared<BiasedMergeQueue>()};
+  ~BiasedMergeQueueHolder() {
+    queue->orphan();
+  }
+};
+inline const std::shared_ptr<BiasedMergeQueue>& localBiasedQueue() {
+  thread_local BiasedMergeQueueHolder holder;
+  return holder.queue;
+}
+// Owner threads call this at safe points to merge blocks other threads sent back
+inline void drainBiasedRefCounts() {
+  localBiasedQueue()->drain();
+}
 
 template<typename T>
+struct ControlBlock<T, RefCountMode::Biased> final : BiasedCountBase {
+private:
+  T* m_ptr{nullptr};
+  bool m_inplace{false};
+  std::shared_ptr<BiasedMergeQueue> m_ownerQueue{localBiasedQueue()}; // Outlives owner thread if needed
+public:
+  using ObjectT = T;
+  explicit ControlBlock(T* rawPtr) : m_ptr{rawPtr} {
+    if (m_ownerQueue->hasPending.load(std::memory_order_relaxed)) {
+      m_ownerQueue->drain();
+    }
+  }
+  ControlBlock(T* objectPtr, InplaceTag) : ControlBlock{objectPtr} {
+    m_inplace = true;
+  }
+  void acquireStrong() {
+    if (onOwnerFastPath()) {
+      m_biased.store(m_biased.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    else {
+      m_shared.fetch_add(ONE, std::memory_order_relaxed);
+    }
+  }
+  // Returns true if the block should be deleted, deletion already happened inside strongZero for Biased
+  bool releaseStrong() {
+    if (onOwnerFastPath()) {
+      int64_t biased = m_biased.load(std::memory_order_relaxed) - 1;
+      m_biased.store(biased, std::memory_order_relaxed);
+      if (biased == 0) {
+        merge();
+      }
+    }
+    else {
+      releaseShared();
+    }
+    return false;
+  }
+  bool tryAcquireStrong() {
+    if (onOwnerFastPath()) {
+      // Unmerged means owner still counts at least one reference : object is alive
+      acquireStrong();
+      return true;
+    }
+    int64_t old = m_shared.load(std::memory_order_relaxed);
+    while (!((old & MERGED) && (old >> 1) == 0)) {
+      if (m_shared.compare_exchange_weak(old, old + ONE, std::memory_order_acquire, std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    return false;
+  }
+  // Exact on owner thread, a snapshot elsewhere
+  size_t getUsedCount() const {
+    int64_t count = m_biased.load(std::memory_order_relaxed) + (m_shared.load(std::memory_order_relaxed) >> 1);
+    return static_cast<size_t>(std::max<int64_t>(count, 0));
+  }
+  size_t getWeakCount() const {
+    return weakCountExcludingStrong(getUsedCount() != 0);
+  }
+  T* get() const {
+    return m_ptr;
+  }
+  bool inplace() const {
+    return m_inplace;
+  }
+  void destroyObject() noexcept override {
+    if (m_inplace) {
+      m_ptr->~T();
+    }
+    else {
+      delete m_ptr;
+    }
+  }
+  void deleteSelf() noexcept override {
+    destroyControlBlock(this);
+  }
+  void queueToOwner() override {
+    m_ownerQueue->push(this);
+  }
+  ControlBlock(const ControlBlock&) = delete;
+  ControlBlock& operator=(const ControlBlock&) = delete;
+};
+
+template<typename T, RefCountMode Mode>
+class WeakPtr;
+template<typename T>
+class AtomicSharedPtr;
+
+template<typename T, RefCountMode Mode = RefCountMode::SingleThreaded>
 class SharedPtr {
 public:
   using DataType = T;
 private:
-  using ControlBlockT = ControlBlock<T>;
+  using ControlBlockT = ControlBlock<T, Mode>;
   ControlBlockT* m_controlBlockPtr{nullptr};
 
   // Ctor / getter for weak pointer: mark weakPtr as friend to access this
-  template<typename U>
+  template<typename U, RefCountMode M>
   friend class WeakPtr;
+  template<typename U>
+  friend class AtomicSharedPtr;
+  template<typename U, RefCountMode M, typename... ArgsT>
+  friend SharedPtr<U, M> makeShared(ArgsT&&... args);
 
-  explicit SharedPtr(ControlBlockT* controlBlockPtr) {
+  // Adopts a strong reference already taken by WeakPtr::lock / makeShared
+  struct AdoptTag {};
+  SharedPtr(ControlBlockT* controlBlockPtr, AdoptTag) : m_controlBlockPtr{controlBlockPtr} {
     assert(controlBlockPtr != nullptr);
-    m_controlBlockPtr = controlBlockPtr;
-    m_controlBlockPtr->acquireStrong();
   }
   ControlBlockT* getControlBlockPtr() const {
     return m_controlBlockPtr;
@@ -76,9 +486,8 @@ private:
   // Release Ownership
   void release() noexcept {
     if (m_controlBlockPtr == nullptr) return;
-    m_controlBlockPtr->releaseStrong();
-    if (m_controlBlockPtr->dead()) {
-      delete m_controlBlockPtr;     
+    if (m_controlBlockPtr->releaseStrong()) {
+      destroyControlBlock(m_controlBlockPtr);
     }
     m_controlBlockPtr = nullptr;
   }
@@ -92,7 +501,7 @@ public:
     if (rawPtr == nullptr) return;
     // Guarantee that resource is released if ctor throw
     try {
-      m_controlBlockPtr = new ControlBlock(rawPtr);
+      m_controlBlockPtr = new ControlBlockT(rawPtr);
       m_controlBlockPtr->acquireStrong();
     }
     catch(...) {
@@ -103,7 +512,7 @@ public:
 
 
   // Rule of 5
-  
+
   // Acquire shared ownership
   SharedPtr(const SharedPtr& other) noexcept : m_controlBlockPtr{other.m_controlBlockPtr}  {
     if (m_controlBlockPtr != nullptr) {
@@ -193,16 +602,16 @@ public:
 };
 
 
-template<typename T>
+template<typename T, RefCountMode Mode = RefCountMode::SingleThreaded>
 class WeakPtr {
 private:
-  using ControlBlockT = ControlBlock<T>;
+  using ControlBlockT = ControlBlock<T, Mode>;
   ControlBlockT* m_controlBlockPtr{nullptr};
 public:
   using DataType = T;
 
   WeakPtr() = default;
-  explicit WeakPtr(const SharedPtr<T>& sharedPtr) : 
+  explicit WeakPtr(const SharedPtr<T, Mode>& sharedPtr) :
       m_controlBlockPtr{sharedPtr.getControlBlockPtr()} {
     if (m_controlBlockPtr != nullptr) {
       m_controlBlockPtr->acquireWeak();
@@ -223,7 +632,7 @@ public:
   WeakPtr(WeakPtr&& other) : m_controlBlockPtr{other.m_controlBlockPtr} {
     other.m_controlBlockPtr = nullptr;
   }
-  // Copy Assign 
+  // Copy Assign
   WeakPtr& operator=(const WeakPtr& other) {
     if (this == &other) {
       return *this;
@@ -251,12 +660,11 @@ public:
   }
   // Rule of 5 end
 
-  SharedPtr<T> lock() const {
-    if (m_controlBlockPtr == nullptr || expired()) {
-      return SharedPtr<T>{};
+  SharedPtr<T, Mode> lock() const {
+    if (m_controlBlockPtr == nullptr || !m_controlBlockPtr->tryAcquireStrong()) {
+      return SharedPtr<T, Mode>{};
     }
-    SharedPtr<T> ret{m_controlBlockPtr};
-    return ret;
+    return SharedPtr<T, Mode>{m_controlBlockPtr, typename SharedPtr<T, Mode>::AdoptTag{}};
   }
 
   bool expired() const {
@@ -271,21 +679,312 @@ public:
   }
 
   DataType* get() const {
-    return (m_controlBlockPtr ? m_controlBlockPtr->get() : nullptr);
+    return (m_controlBlockPtr && !expired() ? m_controlBlockPtr->get() : nullptr);
   }
 
   void reset() {
     if(m_controlBlockPtr == nullptr) {
       return;
     }
-    m_controlBlockPtr->releaseWeak();
-    if (m_controlBlockPtr->dead()) {
-      delete m_controlBlockPtr;
+    if (m_controlBlockPtr->releaseWeak()) {
+      destroyControlBlock(m_controlBlockPtr);
     }
     m_controlBlockPtr = nullptr;
   }
 };
 
+// One allocation for block + object, T is constructed in place behind the block
+template<typename T, RefCountMode Mode = RefCountMode::SingleThreaded, typename... ArgsT>
+SharedPtr<T, Mode> makeShared(ArgsT&&... args) {
+  using BlockT = ControlBlock<T, Mode>;
+  using Layout = InplaceLayout<BlockT>;
+  void* rawBytes = ::operator new(Layout::SIZE, Layout::ALIGN);
+  T* objectPtr = nullptr;
+  BlockT* controlBlockPtr = nullptr;
+  // Guarantee that memory is released if either Ctor throws
+  try {
+    objectPtr = new (static_cast<char*>(rawBytes) + Layout::OBJECT_OFFSET) T(std::forward<ArgsT>(args)...);
+  }
+  catch(...) {
+    ::operator delete(rawBytes, Layout::ALIGN);
+    throw;
+  }
+  try {
+    controlBlockPtr = new (rawBytes) BlockT(objectPtr, InplaceTag{});
+  }
+  catch(...) {
+    objectPtr->~T();
+    ::operator delete(rawBytes, Layout::ALIGN);
+    throw;
+  }
+  controlBlockPtr->acquireStrong();
+  return SharedPtr<T, Mode>{controlBlockPtr, typename SharedPtr<T, Mode>::AdoptTag{}};
+}
+
+/*
+AtomicSharedPtr : a SharedPtr slot many threads can load / store / compare_exchange without a lock,
+for read mostly snapshots (routing tables, configs) that a writer swaps now and then
+    - Split reference count : the slot is one 64 bit word, 48 bit control block address + 16 bit local count
+    - load : fetch_add on the local count reserves the block (it can not die while reserved),
+      then takes a real strong reference and gives the reservation back with a CAS
+    - store / exchange / compare_exchange : swap the word, move the old local count into the block's strong count
+      before dropping the slot's own reference, a reader that lost its CAS drops the extra reference it got
+    - Up to 65535 loads may be between their fetch_add and their CAS at once
+    - Readers still scale with one contended cache line (every load is two RMWs on the slot word),
+      but never block behind a writer or a preempted lock holder
+Uses the Atomic control block, so the SharedPtrs it hands out are SharedPtr<T, RefCountMode::Atomic>
+*/
+template<typename T>
+class AtomicSharedPtr {
+  static_assert(sizeof(void*) == 8, "Split count packing needs 64 bit pointers");
+public:
+  using SharedPtrT = SharedPtr<T, RefCountMode::Atomic>;
+private:
+  using ControlBlockT = ControlBlock<T, RefCountMode::Atomic>;
+  static constexpr uint64_t PTR_BITS = 48;
+  static constexpr uint64_t PTR_MASK = (uint64_t{1} << PTR_BITS) - 1;
+  static constexpr uint64_t LOCAL_ONE = uint64_t{1} << PTR_BITS;
+
+  alignas(64) std::atomic<uint64_t> m_word{0};
+
+  static ControlBlockT* ptrOf(uint64_t word) {
+    return reinterpret_cast<ControlBlockT*>(word & PTR_MASK);
+  }
+  static uint64_t localCountOf(uint64_t word) {
+    return word >> PTR_BITS;
+  }
+  // Takes over the strong reference held by sharedPtr
+  static uint64_t pack(SharedPtrT&& sharedPtr) {
+    uint64_t addr = reinterpret_cast<uint64_t>(sharedPtr.m_controlBlockPtr);
+    assert((addr & ~PTR_MASK) == 0 && "pointer does not fit in 48 bits");
+    sharedPtr.m_controlBlockPtr = nullptr;
+    return addr;
+  }
+  // Hands the slot's reference on a swapped out word to a SharedPtr, after settling its reservations
+  static SharedPtrT adoptOld(uint64_t old) {
+    ControlBlockT* cb = ptrOf(old);
+    if (cb == nullptr) {
+      return SharedPtrT{};
+    }
+    if (uint64_t local = localCountOf(old)) {
+      cb->acquireStrong(local); // Each reserving reader will drop one
+    }
+    return SharedPtrT{cb, typename SharedPtrT::AdoptTag{}};
+  }
+public:
+  AtomicSharedPtr() = default;
+  explicit AtomicSharedPtr(SharedPtrT desired) : m_word{pack(std::move(desired))} {}
+  // Rule of 5 : the slot itself is not copyable, copy what load() returns
+  AtomicSharedPtr(const AtomicSharedPtr&) = delete;
+  AtomicSharedPtr& operator=(const AtomicSharedPtr&) = delete;
+  ~AtomicSharedPtr() {
+    // No concurrent access during destruction : local count is 0
+    adoptOld(m_word.load(std::memory_order_acquire));
+  }
+  // Rule of 5 end
+
+  SharedPtrT load() const {
+    auto& word = const_cast<std::atomic<uint64_t>&>(m_word);
+    uint64_t cur = word.fetch_add(LOCAL_ONE, std::memory_order_acquire) + LOCAL_ONE;
+    assert(localCountOf(cur) != 0 && "local count overflow");
+    ControlBlockT* cb = ptrOf(cur);
+    if (cb != nullptr) {
+      cb->acquireStrong();
+    }
+    // Give the reservation back. Word swapped or local count already 0 means a writer turned
+    // a reservation into a strong reference for us (reservations are interchangeable between readers)
+    while (ptrOf(cur) == cb && localCountOf(cur) != 0) {
+      if (word.compare_exchange_weak(cur, cur - LOCAL_ONE, std::memory_order_relaxed, std::memory_order_relaxed)) {
+        return (cb ? SharedPtrT{cb, typename SharedPtrT::AdoptTag{}} : SharedPtrT{});
+      }
+    }
+    if (cb == nullptr) {
+      return SharedPtrT{}; // Reservations on a null word are dropped by the writer
+    }
+    cb->releaseStrong(); // Can not reach 0 : we still hold the reference taken above
+    return SharedPtrT{cb, typename SharedPtrT::AdoptTag{}};
+  }
+
+  SharedPtrT exchange(SharedPtrT desired) {
+    uint64_t old = m_word.exchange(pack(std::move(desired)), std::memory_order_acq_rel);
+    return adoptOld(old);
+  }
+  void store(SharedPtrT desired) {
+    exchange(std::move(desired)); // Old value dies here
+  }
+
+  // Compares by control block, on failure expected is set to the current value
+  bool compare_exchange_strong(SharedPtrT& expected, SharedPtrT desired) {
+    uint64_t cur = m_word.load(std::memory_order_acquire);
+    uint64_t desiredWord = reinterpret_cast<uint64_t>(desired.m_controlBlockPtr);
+    while (ptrOf(cur) == expected.m_controlBlockPtr) {
+      // Only the local count can change under us while the block matches
+      if (m_word.compare_exchange_weak(cur, desiredWord, std::memory_order_acq_rel, std::memory_order_acquire)) {
+        pack(std::move(desired));
+        adoptOld(cur); // expected still holds a reference, so the old block survives
+        return true;
+      }
+    }
+    expected = load();
+    return false;
+  }
+
+  bool is_lock_free() const {
+    return m_word.is_lock_free();
+  }
+};
+
+// Baseline : SharedPtr copied under a mutex
+template<typename T>
+class MutexSharedPtr {
+public:
+  using SharedPtrT = SharedPtr<T, RefCountMode::Atomic>;
+private:
+  mutable std::mutex m_lock;
+  SharedPtrT m_ptr;
+public:
+  SharedPtrT load() const {
+    std::lock_guard<std::mutex> guard{m_lock};
+    return m_ptr;
+  }
+  void store(SharedPtrT desired) {
+    std::lock_guard<std::mutex> guard{m_lock};
+    std::swap(m_ptr, desired);
+  } // Old value dies outside the lock
+};
+
+struct RouteSnapshot {
+  std::vector<int> routes;
+  explicit RouteSnapshot(int version) : routes(64, version) {}
+};
+
+// Readers load the snapshot and read it, one writer publishes a new snapshot every `writeEveryUs` microseconds
+template<template<typename> class SlotT>
+void benchmarkSnapshotReaders(const char* name, size_t nReaders, size_t nLoadsPerReader, size_t writeEveryUs) {
+  using Snapshot = RouteSnapshot;
+  SlotT<Snapshot> slot;
+  slot.store(typename SlotT<Snapshot>::SharedPtrT{new Snapshot(0)});
+  std::atomic<bool> go{false};
+  std::atomic<size_t> readsDone{0};
+  std::atomic<size_t> sum{0};
+  std::vector<std::thread> readers;
+  for (size_t r = 0; r < nReaders; r++) {
+    readers.emplace_back([&, nLoadsPerReader]() {
+      while (!go.load(std::memory_order_acquire)) {}
+      size_t local = 0;
+      for (size_t i = 0; i < nLoadsPerReader; i++) {
+        auto snapshot = slot.load();
+        local += static_cast<size_t>(snapshot->routes[i & 63]);
+      }
+      sum += local;
+      readsDone++;
+    });
+  }
+  auto start = std::chrono::high_resolution_clock::now();
+  go.store(true, std::memory_order_release);
+  int version = 1;
+  while (readsDone.load(std::memory_order_acquire) != nReaders) {
+    slot.store(typename SlotT<Snapshot>::SharedPtrT{new Snapshot(version++)});
+    std::this_thread::sleep_for(std::chrono::microseconds(writeEveryUs));
+  }
+  for (auto& t : readers) {
+    t.join();
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  std::cout << name << ", " << nReaders << " readers : " << nReaders * nLoadsPerReader << " loads (" << version
+            << " snapshots) took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+}
+
+// Copy / destroy on the creating thread
+template<RefCountMode Mode>
+void benchmarkOwnerCopies(const char* name, size_t nCopies) {
+  SharedPtr<int, Mode> root{new int(0)};
+  std::vector<SharedPtr<int, Mode>> copies(16);
+  auto start = std::chrono::high_resolution_clock::now();
+  for (size_t i = 0; i < nCopies; i++) {
+    copies[i & 15] = root; // drops the previous copy in that slot
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  std::cout << name << " owner thread copies took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+}
+
+// Owner creates objects, hands them to a consumer thread which copies and drops them
+template<RefCountMode Mode>
+void benchmarkHandoff(const char* name, size_t nObjects, size_t nCopies) {
+  std::vector<SharedPtr<int, Mode>> objects;
+  objects.reserve(nObjects);
+  for (size_t i = 0; i < nObjects; i++) {
+    objects.emplace_back(new int(static_cast<int>(i)));
+  }
+  auto start = std::chrono::high_resolution_clock::now();
+  std::thread consumer([&objects, nCopies]() {
+    std::vector<SharedPtr<int, Mode>> mine(std::move(objects));
+    size_t sum = 0;
+    for (auto& p : mine) {
+      for (size_t c = 0; c < nCopies; c++) {
+        SharedPtr<int, Mode> copy{p};
+        sum += static_cast<size_t>(*copy);
+      }
+    }
+    assert(sum > 0);
+  }); // drops every object on the consumer thread
+  consumer.join();
+  if constexpr (Mode == RefCountMode::Biased) {
+    drainBiasedRefCounts(); // owner merges what the consumer sent back, objects die here
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  std::cout << name << " cross thread handoff took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+}
+
+// Follows a random cycle through nObjects shared objects, each object stores the index of the next one
+struct ChaseNode {
+  size_t next;
+  size_t val;
+  ChaseNode(size_t next_, size_t val_) : next{next_}, val{val_} {}
+};
+enum class ChaseAlloc {
+  WrappedLater, // Objects allocated first, blocks later : object and block far apart
+  Separate,     // new T then block, what SharedPtr{new T} does
+  Inplace       // makeShared
+};
+void benchmarkPointerChase(const char* name, ChaseAlloc alloc, size_t nObjects) {
+  std::vector<size_t> order(nObjects);
+  std::iota(order.begin(), order.end(), 0);
+  std::shuffle(order.begin(), order.end(), std::mt19937_64{42});
+  std::vector<size_t> nextOf(nObjects);
+  for (size_t i = 0; i < nObjects; i++) {
+    nextOf[order[i]] = order[(i + 1) % nObjects];
+  }
+  std::vector<SharedPtr<ChaseNode>> objects(nObjects);
+  auto start = std::chrono::high_resolution_clock::now();
+  if (alloc == ChaseAlloc::WrappedLater) {
+    std::vector<ChaseNode*> raw(nObjects);
+    for (size_t i = 0; i < nObjects; i++) {
+      raw[i] = new ChaseNode(nextOf[i], i);
+    }
+    for (size_t i = 0; i < nObjects; i++) {
+      objects[i].reset(raw[i]);
+    }
+  }
+  else {
+    for (size_t i = 0; i < nObjects; i++) {
+      objects[i] = (alloc == ChaseAlloc::Inplace ? makeShared<ChaseNode>(nextOf[i], i) : SharedPtr<ChaseNode>{new ChaseNode(nextOf[i], i)});
+    }
+  }
+  auto built = std::chrono::high_resolution_clock::now();
+  size_t idx = 0;
+  size_t sum = 0;
+  for (size_t i = 0; i < nObjects; i++) {
+    const ChaseNode& node = *objects[idx];
+    sum += node.val;
+    idx = node.next;
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  assert(sum == nObjects * (nObjects - 1) / 2);
+  std::cout << name << " : building took " << std::chrono::duration_cast<std::chrono::nanoseconds>(built - start).count()
+            << " nanoseconds!, pointer chase took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - built).count() << " nanoseconds!\n";
+}
+
 int main() {
   struct A {
     A() {
@@ -339,4 +1038,291 @@ int main() {
   weak3.reset();
   assert(sp.getWeakCount() == 1);
 
+  // Atomic / Biased modes
+  static std::atomic<int> destroyed{0};
+  struct Counted {
+    int val;
+    explicit Counted(int val_) : val{val_} {}
+    ~Counted() {
+      destroyed++;
+    }
+  };
+  {
+    SharedPtr<Counted, RefCountMode::Atomic> a{new Counted(1)};
+    WeakPtr<Counted, RefCountMode::Atomic> w{a};
+    assert(a.getUsedCount() == 1 && a.getWeakCount() == 1);
+    assert(w.lock()->val == 1);
+    a.reset();
+    assert(w.expired() && !w.lock() && w.get() == nullptr && destroyed == 1);
+  }
+  destroyed = 0;
+  {
+    // Owner only : object dies when biased count reaches 0
+    SharedPtr<Counted, RefCountMode::Biased> b{new Counted(2)};
+    SharedPtr<Counted, RefCountMode::Biased> b2{b};
+    WeakPtr<Counted, RefCountMode::Biased> w{b};
+    assert(b.getUsedCount() == 2 && w.lock()->val == 2);
+    b.reset();
+    b2.reset();
+    assert(destroyed == 1 && w.expired() && !w.lock());
+  }
+  destroyed = 0;
+  {
+    // Owner drops first : merged count is handed to the other thread, which destroys
+    SharedPtr<Counted, RefCountMode::Biased> b{new Counted(3)};
+    SharedPtr<Counted, RefCountMode::Biased> other;
+    std::thread t([&other, &b]() {
+      other = b; // non owner increment
+    });
+    t.join();
+    assert(b.getUsedCount() == 2);
+    b.reset(); // biased 0 : merge, shared count 1 remains
+    assert(destroyed == 0);
+    std::thread t2([&other]() {
+      other.reset(); // last reference after merge
+    });
+    t2.join();
+    assert(destroyed == 1);
+  }
+  destroyed = 0;
+  {
+    // Handoff : owner counted the reference, other thread drops it (count goes negative), owner drain destroys
+    SharedPtr<Counted, RefCountMode::Biased> b{new Counted(4)};
+    WeakPtr<Counted, RefCountMode::Biased> w{b};
+    std::thread t([moved = std::move(b)]() mutable {
+      assert(moved->val == 4);
+      moved.reset();
+    });
+    t.join();
+    assert(destroyed == 0); // waits for the owner to merge
+    drainBiasedRefCounts();
+    assert(destroyed == 1 && w.expired());
+  }
+  destroyed = 0;
+  {
+    // Many threads copy / drop a biased pointer while the owner keeps copying too
+    SharedPtr<Counted, RefCountMode::Biased> root{new Counted(5)};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+      threads.emplace_back([root]() {
+        for (int i = 0; i < 50'000; i++) {
+          SharedPtr<Counted, RefCountMode::Biased> c{root};
+          assert(c->val == 5);
+        }
+      });
+    }
+    for (int i = 0; i < 50'000; i++) {
+      SharedPtr<Counted, RefCountMode::Biased> c{root};
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+    drainBiasedRefCounts();
+    assert(destroyed == 0 && root.getUsedCount() == 1);
+    root.reset();
+    drainBiasedRefCounts();
+    assert(destroyed == 1);
+  }
+  destroyed = 0;
+  {
+    // Non owner copies / drops while the owner's count reaches 0 and merges
+    SharedPtr<Counted, RefCountMode::Biased> b{new Counted(6)};
+    std::atomic<bool> started{false};
+    std::thread t([&b, &started]() {
+      SharedPtr<Counted, RefCountMode::Biased> mine{b}; // non owner increment
+      started.store(true, std::memory_order_release);
+      for (int i = 0; i < 50'000; i++) {
+        SharedPtr<Counted, RefCountMode::Biased> c{mine};
+        assert(c->val == 6);
+      }
+    });
+    while (!started.load(std::memory_order_acquire)) {
+      std::this_thread::yield();
+    }
+    b.reset(); // biased 0 : owner merges while the other thread keeps counting
+    t.join();
+    assert(destroyed == 1);
+  }
+  destroyed = 0;
+  {
+    // Owner thread exits first : it merges on exit, the last non owner drop destroys
+    SharedPtr<Counted, RefCountMode::Biased> b;
+    WeakPtr<Counted, RefCountMode::Biased> w;
+    std::thread producer([&b, &w]() {
+      SharedPtr<Counted, RefCountMode::Biased> made{new Counted(7)};
+      w = WeakPtr<Counted, RefCountMode::Biased>{made};
+      b = std::move(made);
+    });
+    producer.join();
+    assert(destroyed == 0 && b->val == 7 && w.lock()->val == 7);
+    b.reset();
+    drainBiasedRefCounts();
+    assert(destroyed == 1 && w.expired());
+
+    // Handed off and dropped by a third thread after the owner is gone
+    std::thread producer2([&b]() {
+      b = makeShared<Counted, RefCountMode::Biased>(8);
+    });
+    producer2.join();
+    std::thread consumer([moved = std::move(b)]() mutable {
+      moved.reset();
+    });
+    consumer.join();
+    assert(destroyed == 2);
+  }
+
+  destroyed = 0;
+  {
+    // AtomicSharedPtr
+    using AtomicPtr = SharedPtr<Counted, RefCountMode::Atomic>;
+    AtomicSharedPtr<Counted> slot;
+    assert(slot.is_lock_free() && !slot.load());
+    AtomicPtr first{new Counted(1)};
+    slot.store(first);
+    assert(slot.load()->val == 1);
+    assert(first.getUsedCount() == 2);
+    AtomicPtr expected{new Counted(7)};
+    assert(!slot.compare_exchange_strong(expected, AtomicPtr{new Counted(2)}));
+    assert(expected.get() == first.get() && destroyed == 2); // Stale expected and the unused desired died
+    assert(slot.compare_exchange_strong(expected, AtomicPtr{new Counted(3)}));
+    assert(slot.load()->val == 3);
+    assert(first.getUsedCount() == 2 && expected.getUsedCount() == 2);
+    expected.reset();
+    first.reset();
+    assert(destroyed == 3);
+    AtomicPtr old = slot.exchange(AtomicPtr{});
+    assert(old->val == 3 && old.getUsedCount() == 1 && !slot.load());
+  }
+  assert(destroyed == 4);
+  destroyed = 0;
+  {
+    // Readers load while writers swap : every snapshot a reader sees must still be alive
+    static constexpr int ALIVE = 0x5a5a;
+    struct Snapshot {
+      int magic{ALIVE};
+      int version;
+      explicit Snapshot(int version_) : version{version_} {}
+      ~Snapshot() {
+        magic = 0;
+        destroyed++;
+      }
+    };
+    using SnapshotPtr = SharedPtr<Snapshot, RefCountMode::Atomic>;
+    AtomicSharedPtr<Snapshot> slot{SnapshotPtr{new Snapshot(0)}};
+    std::atomic<bool> stop{false};
+    std::atomic<int> created{1};
+    std::vector<std::thread> threads;
+    for (int r = 0; r < 4; r++) {
+      threads.emplace_back([&slot, &stop]() {
+        int lastVersion = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+          SnapshotPtr snapshot = slot.load();
+          assert(snapshot->magic == ALIVE);
+          lastVersion = std::max(lastVersion, snapshot->version);
+        }
+        assert(lastVersion >= 0);
+      });
+    }
+    for (int w = 0; w < 2; w++) {
+      threads.emplace_back([&slot, &created, w]() {
+        for (int i = 1; i <= 20'000; i++) {
+          if (i % 2 == 0) {
+            slot.store(SnapshotPtr{new Snapshot(i)});
+            created++;
+            continue;
+          }
+          SnapshotPtr expected = slot.load();
+          created++;
+          if (!slot.compare_exchange_strong(expected, SnapshotPtr{new Snapshot(i + w)})) {
+            assert(expected->magic == ALIVE);
+          }
+        }
+      });
+    }
+    threads[4].join();
+    threads[5].join();
+    stop = true;
+    for (int r = 0; r < 4; r++) {
+      threads[r].join();
+    }
+    assert(destroyed == created - 1); // Only the current snapshot is alive
+  }
+  assert(destroyed == 20'000 * 2 + 1);
+
+  // makeShared : object lives in the block, dies at strong 0, memory stays for weak holders
+  destroyed = 0;
+  {
+    auto p = makeShared<Counted>(11);
+    assert(p->val == 11 && p.getUsedCount() == 1);
+    WeakPtr<Counted> w{p};
+    SharedPtr<Counted> p2{w.lock()};
+    assert(p.getUsedCount() == 2 && w.getWeakCount() == 1);
+    p.reset();
+    p2.reset();
+    assert(destroyed == 1 && w.expired() && !w.lock() && w.get() == nullptr);
+  } // weak frees the block
+  destroyed = 0;
+  {
+    struct alignas(64) Wide {
+      char bytes[64]{};
+      ~Wide() {
+        destroyed++;
+      }
+    };
+    auto atomicPtr = makeShared<Wide, RefCountMode::Atomic>();
+    auto biasedPtr = makeShared<Wide, RefCountMode::Biased>();
+    assert(reinterpret_cast<uintptr_t>(atomicPtr.get()) % 64 == 0 && reinterpret_cast<uintptr_t>(biasedPtr.get()) % 64 == 0);
+    WeakPtr<Wide, RefCountMode::Atomic> wa{atomicPtr};
+    WeakPtr<Wide, RefCountMode::Biased> wb{biasedPtr};
+    atomicPtr.reset();
+    biasedPtr.reset();
+    assert(destroyed == 2 && wa.expired() && wb.expired());
+    // Biased inplace object released from another thread, merged by owner
+    auto handed = makeShared<Wide, RefCountMode::Biased>();
+    std::thread([moved = std::move(handed)]() mutable {
+      moved.reset();
+    }).join();
+    drainBiasedRefCounts();
+    assert(destroyed == 3);
+  }
+  {
+    // Throwing Ctor leaves nothing behind
+    struct Throws {
+      Throws() {
+        throw std::runtime_error("ctor");
+      }
+    };
+    bool caught = false;
+    try {
+      makeShared<Throws>();
+    }
+    catch (const std::runtime_error&) {
+      caught = true;
+    }
+    assert(caught);
+  }
+
+  // Benchmark : pointer chase over 1M shared objects, separate vs inplace object
+  {
+    size_t nObjects = 1'000'000;
+    benchmarkPointerChase("Separate, wrapped later", ChaseAlloc::WrappedLater, nObjects);
+    benchmarkPointerChase("Separate", ChaseAlloc::Separate, nObjects);
+    benchmarkPointerChase("Inplace (makeShared)", ChaseAlloc::Inplace, nObjects);
+  }
+
+  // Benchmark : owner thread copy cost, then cross thread handoff
+  {
+    size_t nCopies = 50'000'000;
+    benchmarkOwnerCopies<RefCountMode::SingleThreaded>("SingleThreaded", nCopies);
+    benchmarkOwnerCopies<RefCountMode::Atomic>("Atomic", nCopies);
+    benchmarkOwnerCopies<RefCountMode::Biased>("Biased", nCopies);
+    benchmarkHandoff<RefCountMode::Atomic>("Atomic", 1'000'000, 4);
+    benchmarkHandoff<RefCountMode::Biased>("Biased", 1'000'000, 4);
+  }
+  // Benchmark : snapshot readers, lock free slot vs mutex
+  for (size_t nReaders : {1, 2, 4, 8}) {
+    size_t nLoads = 2'000'000;
+    benchmarkSnapshotReaders<AtomicSharedPtr>("AtomicSharedPtr", nReaders, nLoads, 100);
+    benchmarkSnapshotReaders<MutexSharedPtr>("MutexSharedPtr", nReaders, nLoads, 100);
+  }
 }
@@ -4,21 +4,45 @@
 #include<cassert>
 #include <memory>
 #include <utility>
+#include <memory_resource>
+#include <string>
+#include <chrono>
 #include<iostream>
 
-template<typename ElemT>
+/*
+AllocT : element blocks are allocated from AllocT, std::allocator keeps aligned operator new
+The block index (m_blockPtrs) stays on the default heap, it is one pointer per BLOCK_SIZE elements
+Allocator propagation on move / swap follows the allocator's traits, same as std containers
+*/
+template<typename ElemT, typename AllocT = std::allocator<ElemT>>
 class Deque {
 private:
+    using AllocTraits = std::allocator_traits<AllocT>;
+    static constexpr bool IS_DEFAULT_ALLOC = std::is_same_v<AllocT, std::allocator<ElemT>>;
     static constexpr size_t BLOCK_SIZE = 1<<8;
     struct Block {
         struct Deleter {
-            void operator()(ElemT* ptr_) const noexcept {
-                ::operator delete(ptr_, std::align_val_t(alignof(ElemT)));
+            [[no_unique_address]] AllocT m_alloc;
+            void operator()(ElemT* ptr_) noexcept {
+                if constexpr (IS_DEFAULT_ALLOC) {
+                    ::operator delete(ptr_, std::align_val_t(alignof(ElemT)));
+                }
+                else {
+                    AllocTraits::deallocate(m_alloc, ptr_, BLOCK_SIZE);
+                }
             }
         };
         std::unique_ptr<ElemT, Deleter> m_data;
-        explicit Block() : m_data{reinterpret_cast<ElemT*>(
-            ::operator new(sizeof(ElemT) * BLOCK_SIZE, std::align_val_t(alignof(ElemT))) )} {
+        static ElemT* allocate(AllocT& alloc_) {
+            if constexpr (IS_DEFAULT_ALLOC) {
+                return reinterpret_cast<ElemT*>(
+                    ::operator new(sizeof(ElemT) * BLOCK_SIZE, std::align_val_t(alignof(ElemT))) );
+            }
+            else {
+                return AllocTraits::allocate(alloc_, BLOCK_SIZE);
+            }
+        }
+        explicit Block(AllocT& alloc_) : m_data{allocate(alloc_), Deleter{alloc_}} {
         }
         ElemT& operator[](size_t i_) {
             return *(m_data.get() + i_);
@@ -44,27 +68,91 @@ private:
     size_t m_frontOffset{}; // Offset in Block where Deque's first element is present
     size_t m_backOffset{}; // Offset in block where Deque's next element is to be inserted
     size_t m_size{};
+    [[no_unique_address]] AllocT m_alloc;
+
+    // Destroys all elements and frees all blocks
+    void release() noexcept {
+        for (size_t i = 0; i < m_blockPtrs.size(); ++i) {
+            size_t start = (i == 0) ? m_frontOffset : 0;
+            size_t end = (i == m_blockPtrs.size() - 1) ? m_backOffset : BLOCK_SIZE;
+            for (size_t j = start; j < end; ++j) {
+                m_blockPtrs[i]->destroyAt(j);
+            }
+        }
+        m_blockPtrs.clear();
+        m_frontOffset = 0;
+        m_backOffset = 0;
+        m_size = 0;
+    }
+    // Steals blocks of other, allocators must compare equal or have been propagated
+    void takeBlocks(Deque& other) noexcept {
+        m_blockPtrs = std::move(other.m_blockPtrs);
+        m_frontOffset = other.m_frontOffset;
+        m_backOffset = other.m_backOffset;
+        m_size = other.m_size;
+        other.m_blockPtrs.clear();
+        other.m_frontOffset = 0;
+        other.m_backOffset = 0;
+        other.m_size = 0;
+    }
 
 public:
     Deque() = default;
+    explicit Deque(const AllocT& alloc) : m_alloc{alloc} {}
 
 
     Deque(const Deque&) = delete;
     Deque& operator=(const Deque&) = delete;
-    ~Deque() {
-        for (size_t i = 0; i < m_blockPtrs.size(); ++i) {
-            size_t start = (i == 0) ? m_frontOffset : 0;
-            size_t end = (i == m_blockPtrs.size() - 1) ? m_backOffset : BLOCK_SIZE;
-            for (size_t j = start; j < end; ++j) {
-                m_blockPtrs[i]->destroyAt(j);
+    // Allocator always moves with the blocks
+    Deque(Deque&& other) noexcept : m_alloc{std::move(other.m_alloc)} {
+        takeBlocks(other);
+    }
+    Deque& operator=(Deque&& other) {
+        if (this == &other) {
+            return *this;
+        }
+        release();
+        if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+            m_alloc = std::move(other.m_alloc);
+            takeBlocks(other);
+        }
+        else if (m_alloc == other.m_alloc) {
+            takeBlocks(other);
+        }
+        else {
+            // Different arenas : blocks can't change hands, move elements one by one
+            for (size_t i = 0; i < other.m_size; i++) {
+                pushBack(std::move(other[i]));
             }
+            other.release();
+        }
+        return *this;
+    }
+    ~Deque() {
+        release();
+    }
+    // Swapping deques with unequal non propagating allocators is undefined, same as std containers
+    friend void swap(Deque& f, Deque& s) noexcept {
+        using std::swap;
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            swap(f.m_alloc, s.m_alloc);
+        }
+        else {
+            assert(f.m_alloc == s.m_alloc);
         }
+        swap(f.m_blockPtrs, s.m_blockPtrs);
+        swap(f.m_frontOffset, s.m_frontOffset);
+        swap(f.m_backOffset, s.m_backOffset);
+        swap(f.m_size, s.m_size);
+    }
+    AllocT get_allocator() const {
+        return m_alloc;
     }
 
     //pushfront
     void pushFront(const ElemT& val_) {
         if (m_size == 0 || m_frontOffset == 0) {
-            auto block = std::make_unique<Block>();
+            auto block = std::make_unique<Block>(m_alloc);
             block->constructAt(BLOCK_SIZE-1, val_);
             m_frontOffset = BLOCK_SIZE-1;
             m_backOffset = (m_size == 0 ? BLOCK_SIZE : m_backOffset);
@@ -79,7 +167,7 @@ public:
     }
     void pushFront(ElemT&& val_) {
         if (m_size == 0 || m_frontOffset == 0) {
-            auto block = std::make_unique<Block>();
+            auto block = std::make_unique<Block>(m_alloc);
             block->constructAt(BLOCK_SIZE-1, std::move(val_));
             m_frontOffset = BLOCK_SIZE-1;
             m_backOffset = (m_size == 0 ? BLOCK_SIZE : m_backOffset);
@@ -95,7 +183,7 @@ public:
     template<typename... ArgsT>
     void emplaceFront(ArgsT&&... args_) {
         if (m_size == 0 || m_frontOffset == 0) {
-            auto block = std::make_unique<Block>();
+            auto block = std::make_unique<Block>(m_alloc);
             block->emplaceAt(BLOCK_SIZE-1, std::forward<ArgsT>(args_)...);
             m_frontOffset = BLOCK_SIZE-1;
             m_backOffset = (m_size == 0 ? BLOCK_SIZE : m_backOffset);
@@ -120,7 +208,7 @@ public:
 
     void pushBack(const ElemT& val_) {
         if (m_size == 0 || m_backOffset == BLOCK_SIZE) {
-            auto block = std::make_unique<Block>();
+            auto block = std::make_unique<Block>(m_alloc);
             block->constructAt(0, val_);
             m_blockPtrs.insert(m_blockPtrs.end(), std::move(block));
             m_backOffset = 1;
@@ -135,7 +223,7 @@ public:
     }
     void pushBack(ElemT&& val_) {
         if (m_size == 0 || m_backOffset == BLOCK_SIZE) {
-            auto block = std::make_unique<Block>();
+            auto block = std::make_unique<Block>(m_alloc);
             block->constructAt(0, std::move(val_));
             m_blockPtrs.insert(m_blockPtrs.end(), std::move(block));
             m_backOffset = 1;
@@ -151,7 +239,7 @@ public:
     template<typename... ArgsT>
     void emplaceBack(ArgsT&&... args_) {
         if (m_size == 0 || m_backOffset == BLOCK_SIZE) {
-            auto block = std::make_unique<Block>();
+            auto block = std::make_unique<Block>(m_alloc);
             block->emplaceAt(0, std::forward<ArgsT>(args_)...);
             m_blockPtrs.insert(m_blockPtrs.end(), std::move(block));
             m_backOffset = 1;
@@ -232,4 +320,49 @@ int main() {
         dq.popFront();
     }
     assert(sum1 == sum2);
+
+    // Allocator propagation
+    {
+        using PmrDeque = Deque<std::string, std::pmr::polymorphic_allocator<std::string>>;
+        std::pmr::monotonic_buffer_resource arena1;
+        std::pmr::monotonic_buffer_resource arena2;
+        PmrDeque d1{&arena1};
+        PmrDeque d2{&arena2};
+        d1.pushBack("b");
+        d1.pushFront("a");
+        d2 = std::move(d1); // polymorphic_allocator does not propagate : element wise move
+        assert(d2.get_allocator().resource() == &arena2);
+        assert(d2.size() == 2 && d2.front() == "a" && d2.back() == "b" && d1.empty());
+        PmrDeque d3{std::move(d2)}; // move construction always takes the allocator
+        assert(d3.get_allocator().resource() == &arena2 && d3.size() == 2);
+        PmrDeque d4{&arena2};
+        swap(d3, d4);
+        assert(d4.size() == 2 && d3.empty());
+    }
+
+    // Benchmark : default heap vs per request arena
+    {
+        size_t nRequests = 100'000;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t r = 0; r < nRequests; r++) {
+            Deque<int> d;
+            for (int i = 0; i < 600; i++) {
+                d.pushBack(i);
+            }
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        std::cout << "Deque default heap took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+
+        start = std::chrono::high_resolution_clock::now();
+        std::vector<std::byte> buffer(1 << 14);
+        for (size_t r = 0; r < nRequests; r++) {
+            std::pmr::monotonic_buffer_resource arena{buffer.data(), buffer.size()};
+            Deque<int, std::pmr::polymorphic_allocator<int>> d{&arena};
+            for (int i = 0; i < 600; i++) {
+                d.pushBack(i);
+            }
+        }
+        end = std::chrono::high_resolution_clock::now();
+        std::cout << "Deque arena took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+    }
 }
\ No newline at end of file
@@ -0,0 +1,277 @@
+#include<iostream>
+#include<cassert>
+#include<cstdint>
+#include<atomic>
+#include<array>
+#include<vector>
+#include<thread>
+#include<mutex>
+#include<chrono>
+#include<memory>
+
+/*
+Lock free LIFO (Treiber stack) for recycling objects between threads
+    - Intrusive : objects derive from LockFreeStackNode, push / pop never allocate
+    - ABA : head is a tagged pointer, 48 bit address + 16 bit counter packed in one 64 bit word
+      bumped on every successful CAS, so a plain 8 byte CAS is enough (no cmpxchg16b / libatomic)
+    - Nodes must stay valid memory while any thread may be inside pop (type stable memory, e.g.
+      a pool of buffers that lives as long as the stack), a racing pop may read next of a node
+      that was just taken, the tag makes its CAS fail
+    - Elimination backoff : on a failed CAS, push parks its node in a random slot of a small array
+      for a short spin and a failed pop checks a random slot, a matched push / pop pair completes
+      without touching the head at all
+
+check: trivialtyperesizablestack.cpp for the single threaded stacks
+*/
+struct LockFreeStackNode {
+  std::atomic<LockFreeStackNode*> next{nullptr};
+};
+
+template<typename T, bool UseElimination = true, size_t N_SLOTS = 8>
+class LockFreeStack {
+  static_assert(std::is_base_of_v<LockFreeStackNode, T>, "T must derive from LockFreeStackNode");
+  static_assert(sizeof(void*) == 8, "Tagged pointer packing needs 64 bit pointers");
+private:
+  using Node = LockFreeStackNode;
+  static constexpr uint64_t PTR_BITS = 48;
+  static constexpr uint64_t PTR_MASK = (uint64_t{1} << PTR_BITS) - 1;
+  static constexpr int ELIMINATION_SPINS = 128;
+
+  // align with 64 to avoid false sharing with slots / neighbours
+  struct alignas(64) Slot {
+    std::atomic<Node*> node{nullptr};
+  };
+
+  alignas(64) std::atomic<uint64_t> m_head{0};
+  std::array<Slot, N_SLOTS> m_slots{};
+
+  static Node* ptrOf(uint64_t tagged) {
+    return reinterpret_cast<Node*>(tagged & PTR_MASK);
+  }
+  static uint64_t pack(Node* node, uint64_t tagged) {
+    uint64_t addr = reinterpret_cast<uint64_t>(node);
+    assert((addr & ~PTR_MASK) == 0 && "pointer does not fit in 48 bits");
+    uint64_t tag = (tagged >> PTR_BITS) + 1; // wraps within 16 bits
+    return addr | (tag << PTR_BITS);
+  }
+
+  static void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+  }
+  static Slot* randomSlot(Slot* slots) {
+    thread_local uint32_t x = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&x) >> 4) | 1; // xorshift32
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return slots + (x % N_SLOTS);
+  }
+  // Returns true if a pop took the node
+  bool eliminatePush(Node* node) {
+    Slot* slot = randomSlot(m_slots.data());
+    Node* expected = nullptr;
+    if (!slot->node.compare_exchange_strong(expected, node, std::memory_order_release, std::memory_order_relaxed)) {
+      return false; // slot busy
+    }
+    for (int i = 0; i < ELIMINATION_SPINS; i++) {
+      if (slot->node.load(std::memory_order_acquire) != node) {
+        return true;
+      }
+      cpuRelax();
+    }
+    // Withdraw, failing means a pop took it in the meantime
+    expected = node;
+    return !slot->node.compare_exchange_strong(expected, nullptr, std::memory_order_relaxed, std::memory_order_relaxed);
+  }
+  Node* eliminatePop() {
+    Slot* slot = randomSlot(m_slots.data());
+    Node* node = slot->node.load(std::memory_order_acquire);
+    if (node != nullptr && slot->node.compare_exchange_strong(node, nullptr, std::memory_order_acquire, std::memory_order_relaxed)) {
+      return node;
+    }
+    return nullptr;
+  }
+
+public:
+  LockFreeStack() = default;
+  // Rule of 5 : nodes are owned by the user, stack only links them
+  LockFreeStack(const LockFreeStack&) = delete;
+  LockFreeStack& operator=(const LockFreeStack&) = delete;
+  // Rule of 5 end
+
+  void push(T* val) {
+    Node* node = static_cast<Node*>(val);
+    uint64_t head = m_head.load(std::memory_order_relaxed);
+    while (true) {
+      node->next.store(ptrOf(head), std::memory_order_relaxed);
+      if (m_head.compare_exchange_weak(head, pack(node, head), std::memory_order_release, std::memory_order_relaxed)) {
+        return;
+      }
+      if constexpr (UseElimination) {
+        if (eliminatePush(node)) {
+          return;
+        }
+        head = m_head.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Returns nullptr if stack is empty
+  T* pop() {
+    uint64_t head = m_head.load(std::memory_order_acquire);
+    while (true) {
+      Node* node = ptrOf(head);
+      if (node == nullptr) {
+        if constexpr (UseElimination) {
+          // A push may be parked in a slot
+          return static_cast<T*>(eliminatePop());
+        }
+        return nullptr;
+      }
+      Node* next = node->next.load(std::memory_order_relaxed);
+      if (m_head.compare_exchange_weak(head, pack(next, head), std::memory_order_acquire, std::memory_order_acquire)) {
+        return static_cast<T*>(node);
+      }
+      if constexpr (UseElimination) {
+        if (Node* other = eliminatePop()) {
+          return static_cast<T*>(other);
+        }
+        head = m_head.load(std::memory_order_acquire);
+      }
+    }
+  }
+
+  // Snapshot, may be stale by the time it returns
+  bool empty() const {
+    return ptrOf(m_head.load(std::memory_order_acquire)) == nullptr;
+  }
+};
+
+// Baseline : std::vector guarded by a mutex
+template<typename T>
+class MutexStack {
+  std::mutex m_lock;
+  std::vector<T*> m_vals;
+public:
+  void push(T* val) {
+    std::lock_guard<std::mutex> guard{m_lock};
+    m_vals.push_back(val);
+  }
+  T* pop() {
+    std::lock_guard<std::mutex> guard{m_lock};
+    if (m_vals.empty()) {
+      return nullptr;
+    }
+    T* val = m_vals.back();
+    m_vals.pop_back();
+    return val;
+  }
+};
+
+struct Buffer : LockFreeStackNode {
+  std::atomic<int> inUse{0}; // Detects a buffer handed to two threads at once
+  size_t owner{0};
+  char data[64]{};
+};
+
+// Every thread pops a buffer, marks it, and pushes it back : no buffer may be lost or duplicated
+template<typename StackT>
+void stressTest(size_t nThreads, size_t nBuffers, size_t nIterations) {
+  std::vector<std::unique_ptr<Buffer>> buffers;
+  StackT stack;
+  for (size_t i = 0; i < nBuffers; i++) {
+    buffers.push_back(std::make_unique<Buffer>());
+    stack.push(buffers.back().get());
+  }
+  std::atomic<size_t> failures{0};
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < nThreads; t++) {
+    threads.emplace_back([&stack, &failures, t, nIterations]() {
+      for (size_t i = 0; i < nIterations; i++) {
+        Buffer* buf = stack.pop();
+        if (buf == nullptr) {
+          continue;
+        }
+        if (buf->inUse.exchange(1) != 0) {
+          failures++;
+        }
+        buf->owner = t;
+        buf->data[0] = static_cast<char>(i);
+        buf->inUse.store(0);
+        stack.push(buf);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  assert(failures == 0);
+  size_t count = 0;
+  while (Buffer* buf = stack.pop()) {
+    assert(buf->inUse == 0);
+    count++;
+  }
+  assert(count == nBuffers);
+}
+
+// Pop / push pairs per second across threads
+template<typename StackT>
+void benchmarkThroughput(const char* name, size_t nThreads, size_t nOpsPerThread) {
+  std::vector<std::unique_ptr<Buffer>> buffers;
+  StackT stack;
+  for (size_t i = 0; i < nThreads * 4; i++) {
+    buffers.push_back(std::make_unique<Buffer>());
+    stack.push(buffers.back().get());
+  }
+  std::atomic<bool> go{false};
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < nThreads; t++) {
+    threads.emplace_back([&stack, &go, nOpsPerThread]() {
+      while (!go.load(std::memory_order_acquire)) {}
+      for (size_t i = 0; i < nOpsPerThread; i++) {
+        if (Buffer* buf = stack.pop()) {
+          stack.push(buf);
+        }
+      }
+    });
+  }
+  auto start = std::chrono::high_resolution_clock::now();
+  go.store(true, std::memory_order_release);
+  for (auto& t : threads) {
+    t.join();
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+  std::cout << name << ", " << nThreads << " threads : " << nThreads * nOpsPerThread << " pop/push pairs took "
+            << ns << " nanoseconds!\n";
+}
+
+int main() {
+  {
+    LockFreeStack<Buffer> stack;
+    Buffer a, b, c;
+    assert(stack.empty() && stack.pop() == nullptr);
+    stack.push(&a);
+    stack.push(&b);
+    stack.push(&c);
+    assert(stack.pop() == &c);
+    assert(stack.pop() == &b);
+    stack.push(&c);
+    assert(stack.pop() == &c);
+    assert(stack.pop() == &a);
+    assert(stack.empty());
+  }
+
+  stressTest<LockFreeStack<Buffer>>(8, 16, 200'000);
+  stressTest<LockFreeStack<Buffer, false>>(8, 16, 200'000);
+  stressTest<LockFreeStack<Buffer>>(8, 2, 200'000); // fewer buffers than threads : lots of empty pops
+
+  // Benchmark
+  for (size_t nThreads : {1, 2, 4, 8}) {
+    size_t nOps = 2'000'000;
+    benchmarkThroughput<LockFreeStack<Buffer>>("LockFreeStack elimination", nThreads, nOps);
+    benchmarkThroughput<LockFreeStack<Buffer, false>>("LockFreeStack", nThreads, nOps);
+    benchmarkThroughput<MutexStack<Buffer>>("MutexStack", nThreads, nOps);
+  }
+}
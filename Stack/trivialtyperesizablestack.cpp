@@ -1,3 +1,37 @@
+#include<iostream>
+#include<cassert>
+#include<cstring>
+#include<cstdint>
+#include<limits>
+#include<new>
+#include<type_traits>
+#include<chrono>
+#include<array>
+#include<span>
+#include<vector>
+#include<cstdlib>
+
+/*
+Bounds checks : STACK_CHECKED=1 makes pop / top / pop_n abort on underflow, on by default unless NDEBUG
+so a release build pays nothing, define STACK_CHECKED=1 to keep checks in an optimized build
+*/
+#ifndef STACK_CHECKED
+  #ifdef NDEBUG
+    #define STACK_CHECKED 0
+  #else
+    #define STACK_CHECKED 1
+  #endif
+#endif
+
+inline void stackCheck(bool ok, const char* msg) {
+  if constexpr (STACK_CHECKED) {
+    if (!ok) [[unlikely]] {
+      std::cerr << "stack check failed : " << msg << '\n';
+      std::abort();
+    }
+  }
+}
+
 template<typename T>
 class FastResizableStack {
   static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>, 
@@ -7,6 +41,19 @@ private:
   size_t m_cap{0};
   // top is insertion point - 1 so init to max value which wraps arounds to 0 on increment
   size_t m_top{std::numeric_limits<size_t>::max()};
+
+  // Doubles until minCap fits
+  void grow(size_t minCap) {
+    size_t newCap = m_cap;
+    while (newCap < minCap) {
+      newCap <<= 1;
+    }
+    T* newArr = reinterpret_cast<T*>(::operator new[](newCap * sizeof(T), std::align_val_t(alignof(T))));
+    memcpy(newArr, m_arr, sizeof(T) * size());
+    m_cap = newCap;
+    ::operator delete[](m_arr, std::align_val_t(alignof(T)));
+    m_arr = newArr;
+  }
 public:
   explicit FastResizableStack(size_t cap) : m_cap{cap ? cap : 1} {
     m_arr = reinterpret_cast<T*>(::operator new[](m_cap * sizeof(T), std::align_val_t(alignof(T))));
@@ -16,24 +63,45 @@ public:
       m_arr[++m_top] = val; 
       return;
     }  
-    T* newArr = reinterpret_cast<T*>(::operator new[]((m_cap<<1) * sizeof(T), std::align_val_t(alignof(T))));
-    memcpy(newArr, m_arr, sizeof(T) * m_cap);
-    m_cap = (m_cap << 1);
-    ::operator delete[](m_arr, std::align_val_t(alignof(T)));
-    m_arr = newArr;
+    grow(m_cap + 1);
     m_arr[++m_top] = val; 
   }
-  // Pop will work regardless, correctness to be enured by user
+  // Bulk push : one capacity check and one memcpy (vectorized by libc) for the whole range,
+  // vals.back() ends up on top
+  void push_n(std::span<const T> vals) {
+    size_t newSize = size() + vals.size();
+    if (newSize > m_cap) {
+      grow(newSize);
+    }
+    if (!vals.empty()) {
+      memcpy(m_arr + size(), vals.data(), vals.size_bytes());
+    }
+    m_top += vals.size();
+  }
+  // Pop will work regardless, correctness to be enured by user (checked in debug)
   void pop() {
+    stackCheck(!empty(), "pop on empty stack");
     m_top--;
   }
-  // Top will return regardless, correctness to be enured by user
+  // Bulk pop : copies top n elements to out keeping stack order, so out[n-1] was the top
+  void pop_n(T* out, size_t n) {
+    stackCheck(n <= size(), "pop_n past bottom of stack");
+    if (n != 0) {
+      memcpy(out, m_arr + (size() - n), n * sizeof(T));
+    }
+    m_top -= n;
+  }
+  // Top will return regardless, correctness to be enured by user (checked in debug)
   T top() const {
+    stackCheck(!empty(), "top on empty stack");
     return m_arr[m_top];
   }
   bool empty() const {
     return m_top == std::numeric_limits<size_t>::max();
   }
+  size_t size() const {
+    return m_top + 1; // wraps to 0 when empty
+  }
 
   // Rule of 5
   ~FastResizableStack() {
@@ -43,3 +111,379 @@ public:
   FastResizableStack& operator=(const FastResizableStack&) = delete;
   // Rule of 5
 };
+
+/*
+Segmented stack : growth chains a new segment instead of copying, so push / pop are O(1) worst case
+    - Segment k holds base << k elements, total capacity still doubles and there are at most 64 segments,
+      so the segment directory is a fixed array and never reallocates
+    - Old segments are never touched on growth : no memcpy spike, pointers into the stack stay valid
+    - Shrink policy : when pop empties a segment we step back to the previous one and keep the emptied
+      segment as a spare, the spare above it is freed. One spare avoids alloc / free thrash when
+      the top oscillates around a segment boundary
+    - Cost : one extra compare on pop, elements are not contiguous across segments
+*/
+template<typename T>
+class SegmentedStack {
+  static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>,
+                "SegmentedStack only works for trivially copyable / destructible types");
+private:
+  static constexpr size_t MAX_SEGMENTS = 64;
+
+  std::array<T*, MAX_SEGMENTS> m_segments{}; // nullptr if not allocated
+  size_t m_base{0}; // Capacity of segment 0
+  size_t m_seg{0}; // Current segment
+  // Current segment range, m_cur is insertion point
+  T* m_cur{nullptr};
+  T* m_segBegin{nullptr};
+  T* m_segEnd{nullptr};
+
+  size_t segmentCap(size_t seg) const {
+    return m_base << seg;
+  }
+  T* allocateSegment(size_t seg) {
+    return reinterpret_cast<T*>(::operator new[](segmentCap(seg) * sizeof(T), std::align_val_t(alignof(T))));
+  }
+  void freeSegment(size_t seg) {
+    ::operator delete[](m_segments[seg], std::align_val_t(alignof(T)));
+    m_segments[seg] = nullptr;
+  }
+  void enterSegment(size_t seg) {
+    m_seg = seg;
+    m_segBegin = m_segments[seg];
+    m_segEnd = m_segBegin + segmentCap(seg);
+  }
+  // Slow path of push : current segment is full
+  void nextSegment() {
+    assert(m_seg + 1 < MAX_SEGMENTS && (m_base << (m_seg + 1)) >> (m_seg + 1) == m_base && "SegmentedStack capacity overflow");
+    if (m_segments[m_seg + 1] == nullptr) {
+      m_segments[m_seg + 1] = allocateSegment(m_seg + 1);
+    }
+    enterSegment(m_seg + 1);
+    m_cur = m_segBegin;
+  }
+  // Slow path of pop : current segment became empty, keep it as spare and free the one above
+  void prevSegment() {
+    if (m_seg + 1 < MAX_SEGMENTS && m_segments[m_seg + 1] != nullptr) {
+      freeSegment(m_seg + 1);
+    }
+    enterSegment(m_seg - 1);
+    m_cur = m_segEnd;
+  }
+public:
+  explicit SegmentedStack(size_t cap) : m_base{cap ? cap : 1} {
+    m_segments[0] = allocateSegment(0);
+    enterSegment(0);
+    m_cur = m_segBegin;
+  }
+  void push(T val) {
+    if (m_cur == m_segEnd) [[unlikely]] {
+      nextSegment();
+    }
+    *m_cur++ = val;
+  }
+  // Pop will work regardless, correctness to be enured by user (checked in debug)
+  void pop() {
+    stackCheck(!empty(), "pop on empty stack");
+    --m_cur;
+    // Invariant : m_cur > m_segBegin unless the stack is empty, so top() is always m_cur[-1]
+    if (m_cur == m_segBegin && m_seg != 0) [[unlikely]] {
+      prevSegment();
+    }
+  }
+  // Top will return regardless, correctness to be enured by user (checked in debug)
+  T top() const {
+    stackCheck(!empty(), "top on empty stack");
+    return m_cur[-1];
+  }
+  bool empty() const {
+    return m_seg == 0 && m_cur == m_segBegin;
+  }
+  size_t size() const {
+    // Segments below m_seg hold base * (2^m_seg - 1) elements
+    return (segmentCap(m_seg) - m_base) + static_cast<size_t>(m_cur - m_segBegin);
+  }
+  // Allocated elements including spare segment
+  size_t capacity() const {
+    size_t cap = 0;
+    for (size_t seg = 0; seg < MAX_SEGMENTS && m_segments[seg] != nullptr; seg++) {
+      cap += segmentCap(seg);
+    }
+    return cap;
+  }
+  // Frees the spare segment kept by the shrink policy
+  void shrinkToFit() {
+    if (m_seg + 1 < MAX_SEGMENTS && m_segments[m_seg + 1] != nullptr) {
+      freeSegment(m_seg + 1);
+    }
+  }
+
+  // Rule of 5
+  ~SegmentedStack() {
+    for (size_t seg = 0; seg < MAX_SEGMENTS; seg++) {
+      if (m_segments[seg] != nullptr) {
+        freeSegment(seg);
+      }
+    }
+  }
+  SegmentedStack(const SegmentedStack&) = delete;
+  SegmentedStack& operator=(const SegmentedStack&) = delete;
+  // Rule of 5
+};
+
+// Times every push and buckets latency in powers of 4 starting at 64ns
+template<typename StackT>
+void benchmarkPushLatency(const char* name, size_t n) {
+  constexpr size_t N_BUCKETS = 10;
+  std::array<size_t, N_BUCKETS> histogram{};
+  int64_t worst = 0;
+  StackT stack{16};
+  auto total = std::chrono::high_resolution_clock::now();
+  for (size_t i = 0; i < n; i++) {
+    auto start = std::chrono::high_resolution_clock::now();
+    stack.push(static_cast<uint32_t>(i));
+    auto end = std::chrono::high_resolution_clock::now();
+    int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    worst = std::max(worst, ns);
+    size_t bucket = 0;
+    for (int64_t limit = 64; bucket + 1 < N_BUCKETS && ns >= limit; limit <<= 2) {
+      bucket++;
+    }
+    histogram[bucket]++;
+  }
+  auto totalEnd = std::chrono::high_resolution_clock::now();
+  std::cout << name << " : " << n << " pushes took "
+            << std::chrono::duration_cast<std::chrono::nanoseconds>(totalEnd - total).count() << " nanoseconds!, worst push "
+            << worst << " ns\n";
+  int64_t limit = 64;
+  for (size_t bucket = 0; bucket < N_BUCKETS; bucket++, limit <<= 2) {
+    if (histogram[bucket] == 0) continue;
+    if (bucket + 1 == N_BUCKETS) {
+      std::cout << "  >= " << (limit >> 2) << " ns : " << histogram[bucket] << '\n';
+    }
+    else {
+      std::cout << "  < " << limit << " ns : " << histogram[bucket] << '\n';
+    }
+  }
+}
+
+// Adjacency of v is targets[offsets[v] .. offsets[v+1])
+struct CsrGraph {
+  std::vector<uint64_t> offsets;
+  std::vector<uint32_t> targets;
+  uint32_t nVertices() const {
+    return static_cast<uint32_t>(offsets.size() - 1);
+  }
+  std::span<const uint32_t> neighbours(uint32_t v) const {
+    return {targets.data() + offsets[v], targets.data() + offsets[v + 1]};
+  }
+};
+
+CsrGraph makeRandomGraph(uint32_t nVertices, uint32_t degree) {
+  CsrGraph graph;
+  graph.offsets.resize(size_t{nVertices} + 1);
+  graph.targets.resize(size_t{nVertices} * degree);
+  uint64_t x = 88172645463325252ull; // xorshift64
+  for (size_t i = 0; i < graph.targets.size(); i++) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    graph.targets[i] = static_cast<uint32_t>(x % nVertices);
+  }
+  for (size_t v = 0; v <= nVertices; v++) {
+    graph.offsets[v] = v * degree;
+  }
+  return graph;
+}
+
+// Traversals mark visited on pop, so a whole adjacency list can be pushed at once
+// Each returns sum of visited vertex ids as a checksum
+
+size_t dfsVector(const CsrGraph& graph) {
+  std::vector<uint8_t> visited(graph.nVertices(), 0);
+  std::vector<uint32_t> stack;
+  stack.push_back(0);
+  size_t sum = 0;
+  while (!stack.empty()) {
+    uint32_t v = stack.back();
+    stack.pop_back();
+    if (visited[v]) continue;
+    visited[v] = 1;
+    sum += v;
+    for (uint32_t u : graph.neighbours(v)) {
+      stack.push_back(u);
+    }
+  }
+  return sum;
+}
+
+size_t dfsStack(const CsrGraph& graph) {
+  std::vector<uint8_t> visited(graph.nVertices(), 0);
+  FastResizableStack<uint32_t> stack{16};
+  stack.push(0);
+  size_t sum = 0;
+  while (!stack.empty()) {
+    uint32_t v = stack.top();
+    stack.pop();
+    if (visited[v]) continue;
+    visited[v] = 1;
+    sum += v;
+    for (uint32_t u : graph.neighbours(v)) {
+      stack.push(u);
+    }
+  }
+  return sum;
+}
+
+size_t dfsBulk(const CsrGraph& graph) {
+  std::vector<uint8_t> visited(graph.nVertices(), 0);
+  FastResizableStack<uint32_t> stack{16};
+  stack.push(0);
+  size_t sum = 0;
+  while (!stack.empty()) {
+    uint32_t v = stack.top();
+    stack.pop();
+    if (visited[v]) continue;
+    visited[v] = 1;
+    sum += v;
+    stack.push_n(graph.neighbours(v));
+  }
+  return sum;
+}
+
+// Level synchronous, frontier order inside a level does not matter
+size_t bfsVector(const CsrGraph& graph) {
+  std::vector<uint8_t> visited(graph.nVertices(), 0);
+  std::vector<uint32_t> frontier{0}, next;
+  size_t sum = 0;
+  while (!frontier.empty()) {
+    while (!frontier.empty()) {
+      uint32_t v = frontier.back();
+      frontier.pop_back();
+      if (visited[v]) continue;
+      visited[v] = 1;
+      sum += v;
+      for (uint32_t u : graph.neighbours(v)) {
+        next.push_back(u);
+      }
+    }
+    std::swap(frontier, next);
+  }
+  return sum;
+}
+
+size_t bfsBulk(const CsrGraph& graph) {
+  constexpr size_t CHUNK = 256;
+  std::vector<uint8_t> visited(graph.nVertices(), 0);
+  FastResizableStack<uint32_t> frontier{16}, next{16};
+  FastResizableStack<uint32_t>* cur = &frontier;
+  FastResizableStack<uint32_t>* nxt = &next;
+  cur->push(0);
+  uint32_t chunk[CHUNK];
+  size_t sum = 0;
+  while (!cur->empty()) {
+    while (!cur->empty()) {
+      size_t n = std::min(CHUNK, cur->size());
+      cur->pop_n(chunk, n);
+      for (size_t i = 0; i < n; i++) {
+        uint32_t v = chunk[i];
+        if (visited[v]) continue;
+        visited[v] = 1;
+        sum += v;
+        nxt->push_n(graph.neighbours(v));
+      }
+    }
+    std::swap(cur, nxt);
+  }
+  return sum;
+}
+
+template<typename FnT>
+void timeTraversal(const char* name, FnT fn) {
+  auto start = std::chrono::high_resolution_clock::now();
+  fn();
+  auto end = std::chrono::high_resolution_clock::now();
+  std::cout << name << " took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+}
+
+int main() {
+  {
+    SegmentedStack<int> stack{2};
+    assert(stack.empty() && stack.size() == 0);
+    for (int i = 0; i < 100; i++) {
+      stack.push(i);
+      assert(stack.top() == i);
+    }
+    assert(stack.size() == 100);
+    size_t grownCap = stack.capacity(); // 2 + 4 + ... + 64
+    assert(grownCap == 126);
+    for (int i = 99; i >= 10; i--) {
+      assert(stack.top() == i);
+      stack.pop();
+    }
+    assert(stack.size() == 10 && stack.top() == 9);
+    assert(stack.capacity() == 30); // 2 + 4 + 8 in use and 16 kept as spare, the rest were returned
+    // Oscillate across the 14/15 boundary : the spare segment (elements 14..29) is re-entered, not reallocated
+    size_t cap = stack.capacity();
+    for (int i = 10; i < 14; i++) {
+      stack.push(i);
+    }
+    for (int rep = 0; rep < 100; rep++) {
+      stack.push(14);
+      assert(stack.size() == 15 && stack.capacity() == cap);
+      stack.pop();
+      assert(stack.size() == 14 && stack.capacity() == cap);
+    }
+    for (int i = 13; i >= 10; i--) {
+      assert(stack.top() == i);
+      stack.pop();
+    }
+    assert(stack.capacity() == cap && stack.top() == 9);
+    while (!stack.empty()) {
+      stack.pop();
+    }
+    stack.shrinkToFit();
+    assert(stack.capacity() == 2);
+    stack.push(42);
+    assert(stack.top() == 42 && stack.size() == 1);
+  }
+  {
+    FastResizableStack<int> stack{1};
+    for (int i = 0; i < 10; i++) {
+      stack.push(i);
+    }
+    assert(stack.top() == 9);
+    stack.pop();
+    assert(stack.top() == 8);
+
+    int vals[] = {100, 101, 102, 103, 104, 105, 106, 107, 108, 109, 110, 111, 112, 113, 114, 115, 116};
+    stack.push_n(vals); // grows past 16 in one step
+    assert(stack.size() == 26 && stack.top() == 116);
+    int out[20];
+    stack.pop_n(out, 18);
+    assert(out[0] == 8 && out[1] == 100 && out[17] == 116);
+    assert(stack.size() == 8 && stack.top() == 7);
+    stack.pop_n(out, 8);
+    assert(stack.empty());
+    stack.push_n(std::span<const int>{});
+    assert(stack.empty());
+  }
+
+  // Benchmark : DFS / BFS frontier on a random graph, std::vector as stack vs push loop vs push_n
+  {
+    CsrGraph graph = makeRandomGraph(uint32_t{1} << 24, 6); // ~100M edges
+    size_t sumVecDfs = 0, sumStackDfs = 0, sumBulkDfs = 0, sumVecBfs = 0, sumBulkBfs = 0;
+    timeTraversal("DFS std::vector push_back", [&]() { sumVecDfs = dfsVector(graph); });
+    timeTraversal("DFS FastResizableStack push", [&]() { sumStackDfs = dfsStack(graph); });
+    timeTraversal("DFS FastResizableStack push_n", [&]() { sumBulkDfs = dfsBulk(graph); });
+    timeTraversal("BFS std::vector push_back", [&]() { sumVecBfs = bfsVector(graph); });
+    timeTraversal("BFS FastResizableStack push_n / pop_n", [&]() { sumBulkBfs = bfsBulk(graph); });
+    assert(sumVecDfs == sumStackDfs && sumStackDfs == sumBulkDfs && sumVecBfs == sumBulkBfs && sumVecDfs == sumVecBfs);
+  }
+
+  // Benchmark : worst case push latency, 128 MB of uint32_t
+  {
+    size_t n = size_t{1} << 25;
+    benchmarkPushLatency<FastResizableStack<uint32_t>>("FastResizableStack", n);
+    benchmarkPushLatency<SegmentedStack<uint32_t>>("SegmentedStack", n);
+  }
+}
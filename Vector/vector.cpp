@@ -1,68 +1,292 @@
+#ifdef __linux__
+#include<sys/mman.h>
+#endif
+
+/*
+Pending : exception safety of new / Iterator / Testing
+*/
+
 /*
-Pending : Trivial types Fast Path / Allocator / exception safety of new / Iterator / Testing
+Types whose objects can be moved to a new address with memcpy, without running move Ctor + Dtor.
+Trivially copyable types are relocatable by default, user types can opt in by specializing:
+    template<> struct IsTriviallyRelocatable<MyType> : std::true_type {};
+A type is relocatable if it does not store pointers into itself and does not register its address anywhere
 */
 template<typename T>
+struct IsTriviallyRelocatable : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+
+// Moves n elements from src into uninitialized dst and destroys them in src
+// Shared by Vector and SmallVector
+template<typename T>
+void relocateElements(T* dst, T* src, size_t n) {
+    if constexpr (IsTriviallyRelocatable<T>::value) {
+        if (n != 0) {
+            std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), n * sizeof(T));
+        }
+    }
+    else {
+        // Move
+        for (size_t i = 0; i < n; i++) {
+            new (dst + i) T(std::move_if_noexcept(src[i]));
+        }
+        // Destroy
+        for (size_t i = 0; i < n; i++) {
+            (src + i)->~T();
+        }
+    }
+}
+
+// Growth policies for Vector
+struct GrowthFactor2 {
+    static size_t grow(size_t cap) {
+        return cap ? cap << 1 : 1;
+    }
+};
+// 1.5x lets freed blocks eventually be reused by the allocator for the next growth
+struct GrowthFactor1_5 {
+    static size_t grow(size_t cap) {
+        return cap > 1 ? cap + (cap >> 1) : cap + 1;
+    }
+};
+
+/*
+AllocT : std::allocator uses the built in heap / mmap path below,
+any other allocator (e.g. std::pmr::polymorphic_allocator over an arena) is used through std::allocator_traits
+Elements are constructed / destroyed through std::allocator_traits too, so allocator aware elements
+(e.g. std::pmr::string in a PmrVector) draw from the same arena
+Allocator propagation on copy / move / swap follows the allocator's traits, same as std containers
+*/
+template<typename T, typename GrowthPolicyT = GrowthFactor2, typename AllocT = std::allocator<T>>
 class Vector {
 private:
+    using AllocTraits = std::allocator_traits<AllocT>;
+    static constexpr bool IS_DEFAULT_ALLOC = std::is_same_v<AllocT, std::allocator<T>>;
+
     T* m_arr{nullptr};
     size_t m_cap{0};
     size_t m_size{0};
+    [[no_unique_address]] AllocT m_alloc;
+
+    // Buffers of at least this many bytes are mmap'd so they can grow in place with mremap
+    static constexpr size_t MMAP_THRESHOLD = 1 << 20;
 
+    static bool isMapped(size_t cap) {
+#ifdef __linux__
+        return IS_DEFAULT_ALLOC && cap * sizeof(T) >= MMAP_THRESHOLD;
+#else
+        return false;
+#endif
+    }
     void* allocateRaw(size_t size) {
+        if constexpr (!IS_DEFAULT_ALLOC) {
+            return AllocTraits::allocate(m_alloc, size);
+        }
+#ifdef __linux__
+        if (isMapped(size)) {
+            void* ptr = mmap(nullptr, size * sizeof(T), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (ptr == MAP_FAILED) {
+                throw std::bad_alloc{};
+            }
+            return ptr;
+        }
+#endif
         // Allocate raw bytes, set alignment as well while allocating raw bytes
         return ::operator new[](size * sizeof(T), std::align_val_t(alignof(T)));
     }
+    // cap must be the capacity ptr was allocated with
+    void deallocateRaw(T* ptr, size_t cap) noexcept {
+        if constexpr (!IS_DEFAULT_ALLOC) {
+            if (ptr != nullptr) {
+                AllocTraits::deallocate(m_alloc, ptr, cap);
+            }
+            return;
+        }
+#ifdef __linux__
+        if (isMapped(cap)) {
+            munmap(ptr, cap * sizeof(T));
+            return;
+        }
+#endif
+        ::operator delete[](ptr, std::align_val_t(alignof(T)));
+    }
+    // Elements are built / destroyed through the allocator : a pmr allocator hands its resource to allocator aware T
+    template<typename... ArgsT>
+    void construct(T* ptr, ArgsT&&... args) {
+        AllocTraits::construct(m_alloc, ptr, std::forward<ArgsT>(args)...);
+    }
+    void destroy(T* ptr) noexcept {
+        AllocTraits::destroy(m_alloc, ptr);
+    }
+    // relocateElements, through the allocator unless it is the default one or a memcpy is enough
+    void relocate(T* dst, T* src, size_t n) {
+        if constexpr (IS_DEFAULT_ALLOC || IsTriviallyRelocatable<T>::value) {
+            relocateElements(dst, src, n);
+        }
+        else {
+            for (size_t i = 0; i < n; i++) {
+                construct(dst + i, std::move_if_noexcept(src[i]));
+            }
+            for (size_t i = 0; i < n; i++) {
+                destroy(src + i);
+            }
+        }
+    }
     void increaseCapacity(size_t newCap) {
         assert(newCap >= m_cap);
+        if constexpr (IsTriviallyRelocatable<T>::value) {
+#ifdef __linux__
+            // Large buffer : let the kernel extend in place or move the pages, elements are never copied
+            if (isMapped(m_cap)) {
+                void* ptr = mremap(m_arr, m_cap * sizeof(T), newCap * sizeof(T), MREMAP_MAYMOVE);
+                if (ptr == MAP_FAILED) {
+                    throw std::bad_alloc{};
+                }
+                m_arr = reinterpret_cast<T*>(ptr);
+                m_cap = newCap;
+                return;
+            }
+#endif
+        }
         // Allocate new memory
         T* newArrPtr = reinterpret_cast<T*>(allocateRaw(newCap));
-        // Move
-        for (size_t i = 0; i < m_size; i++) { 
-            new (newArrPtr + i) T(std::move_if_noexcept(m_arr[i]));
+        // Relocate : single memcpy for relocatable types, move + destroy per element otherwise
+        relocate(newArrPtr, m_arr, m_size);
+        deallocateRaw(m_arr, m_cap);
+        // Save
+        m_arr = newArrPtr;
+        m_cap = newCap;
+    }
+    // Full : args may refer to an element of this vector, so the new element is built before the old buffer goes away
+    template<typename... ArgsT>
+    void growAndEmplace(ArgsT&&... args) {
+        size_t newCap = GrowthPolicyT::grow(m_cap);
+        if constexpr (IsTriviallyRelocatable<T>::value) {
+            if (isMapped(m_cap)) {
+                // mremap may move the pages under args : take a copy first
+                T tmp(std::forward<ArgsT>(args)...);
+                increaseCapacity(newCap);
+                construct(m_arr + m_size, std::move(tmp));
+                m_size++;
+                return;
+            }
         }
-        // Destroy
-        for (size_t i = 0; i < m_size; i++) {
-            (m_arr + i)->~T();
+        T* newArrPtr = reinterpret_cast<T*>(allocateRaw(newCap));
+        try {
+            construct(newArrPtr + m_size, std::forward<ArgsT>(args)...);
         }
-        ::operator delete[](m_arr, std::align_val_t(alignof(T)));  
-        // Save
+        catch (...) {
+            deallocateRaw(newArrPtr, newCap);
+            throw;
+        }
+        relocate(newArrPtr, m_arr, m_size);
+        deallocateRaw(m_arr, m_cap);
         m_arr = newArrPtr;
         m_cap = newCap;
+        m_size++;
     }
     void reset() noexcept {
         for (size_t i = 0; i < m_size; i++) {
-            (m_arr + i)->~T();
+            destroy(m_arr + i);
         }
-        ::operator delete[](m_arr, std::align_val_t(alignof(T)));  
+        deallocateRaw(m_arr, m_cap);
         m_size = 0;
         m_cap = 0;  
         m_arr = nullptr;
     }
+    // Grows to hold needed elements, keeps growth geometric so repeated bulk appends stay amortized O(1)
+    void ensureCapacity(size_t needed) {
+        if (needed > m_cap) {
+            increaseCapacity(std::max(needed, GrowthPolicyT::grow(m_cap)));
+        }
+    }
+    // Copy constructs [first, last) into uninitialized memory at dst, memcpy if source is contiguous T
+    template<typename ForwardIt>
+    void copyConstruct(T* dst, ForwardIt first, ForwardIt last) {
+        using SrcT = std::remove_cv_t<std::remove_reference_t<std::iter_reference_t<ForwardIt>>>;
+        if constexpr (std::is_trivially_copyable_v<T> && std::contiguous_iterator<ForwardIt> && std::is_same_v<SrcT, T>) {
+            size_t n = static_cast<size_t>(last - first);
+            if (n != 0) {
+                std::memcpy(static_cast<void*>(dst), std::to_address(first), n * sizeof(T));
+            }
+        }
+        else {
+            T* cur = dst;
+            try {
+                for (; first != last; ++first, ++cur) {
+                    construct(cur, *first);
+                }
+            }
+            catch (...) {
+                // Destroy the prefix already built so a throwing copy leaves no live elements behind
+                for (; dst != cur; ++dst) {
+                    destroy(dst);
+                }
+                throw;
+            }
+        }
+    }
+    // Index of first in m_arr if [first, last) is a contiguous range of T inside [m_arr, m_arr + m_size), m_size otherwise
+    template<typename ForwardIt>
+    size_t aliasedOffset(ForwardIt first, ForwardIt last) const {
+        using SrcT = std::remove_cv_t<std::remove_reference_t<std::iter_reference_t<ForwardIt>>>;
+        if constexpr (std::contiguous_iterator<ForwardIt> && std::is_same_v<SrcT, T>) {
+            if (first != last) {
+                const T* src = std::to_address(first);
+                std::less<const T*> less;
+                if (!less(src, m_arr) && less(src, m_arr + m_size)) {
+                    return static_cast<size_t>(src - m_arr);
+                }
+            }
+        }
+        return m_size;
+    }
+
+    // Steals buffer of other, allocators must compare equal or have been propagated
+    void takeBuffer(Vector& other) noexcept {
+        m_arr = other.m_arr;
+        m_cap = other.m_cap;
+        m_size = other.m_size;
+        // Invalidate other 
+        other.m_arr = nullptr;
+        other.m_size = 0;
+        other.m_cap = 0;
+    }
 public:
     Vector() = default;
 
     // Parametrized Ctors
-    Vector(size_t size, const T& defaultValue) {
+    explicit Vector(const AllocT& alloc) : m_alloc{alloc} {}
+    Vector(size_t size, const T& defaultValue, const AllocT& alloc = AllocT()) : m_alloc{alloc} {
         if (size == 0) return;
         // Allocate
         m_arr = reinterpret_cast<T*>(allocateRaw(size));
-        // Copy Construct T
-        for (size_t i = 0; i < size; i++) {
-            new (m_arr + i) T(defaultValue);
-        }
-        m_size = size;
         m_cap = size;
+        // Copy Construct T, Dtor does not run if a Ctor throws
+        try {
+            for (; m_size < size; m_size++) {
+                construct(m_arr + m_size, defaultValue);
+            }
+        }
+        catch (...) {
+            reset();
+            throw;
+        }
     }
-    Vector(size_t size) {
+    Vector(size_t size, const AllocT& alloc = AllocT()) : m_alloc{alloc} {
         if (size == 0) return;
         // Increase capacity
         m_arr = reinterpret_cast<T*>(allocateRaw(size));
+        m_cap = size;
         // Default Construct T
-        for (size_t i = 0; i < size; i++) {
-            new (m_arr + i) T();
+        try {
+            for (; m_size < size; m_size++) {
+                construct(m_arr + m_size);
+            }
+        }
+        catch (...) {
+            reset();
+            throw;
         }
-        m_size = size;
-        m_cap = size;
     }
 
     // Parametrized Ctors End
@@ -73,30 +297,35 @@ public:
     }
 
     // Copying does not copy the capacity, only elements are assured to be copied
-    Vector(const Vector& other) {
+    Vector(const Vector& other) : m_alloc{AllocTraits::select_on_container_copy_construction(other.m_alloc)} {
         if (other.m_size == 0) return;
         m_arr = reinterpret_cast<T*>(allocateRaw(other.m_size));
-        for (size_t i = 0; i < other.m_size; i++) {
-            new (m_arr + i) T(other.m_arr[i]);
+        m_cap = other.m_size;
+        try {
+            copyConstruct(m_arr, other.m_arr, other.m_arr + other.m_size);
+        }
+        catch (...) {
+            deallocateRaw(m_arr, m_cap);
+            throw;
         }
         m_size = other.m_size;
-        m_cap = m_size;
     }
 
-    Vector(Vector&& other) noexcept {
-        // Move
-        m_arr = other.m_arr;
-        m_cap = other.m_cap;
-        m_size = other.m_size;
-        // Invalidate other 
-        other.m_arr = nullptr;
-        other.m_size = 0;
-        other.m_cap = 0;
+    // Allocator always moves with the buffer
+    Vector(Vector&& other) noexcept : m_alloc{std::move(other.m_alloc)} {
+        takeBuffer(other);
     }
 
     // Assigning does not copy the capacity, only elements are assured to be copied
     Vector& operator=(const Vector&other) {
         if (this == &other) return *this;
+        if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+            // Memory from our allocator can not be freed by the new one
+            if (m_alloc != other.m_alloc) {
+                reset();
+            }
+            m_alloc = other.m_alloc;
+        }
         if (other.m_size >= m_size) {
             if (other.m_size > m_cap) {
                 increaseCapacity(other.m_size);
@@ -105,12 +334,12 @@ public:
                 m_arr[i] = other.m_arr[i];
             }
             for (size_t i = m_size; i < other.m_size; i++) {
-                new (m_arr + i) T(other.m_arr[i]);
+                construct(m_arr + i, other.m_arr[i]);
             }
         }
         else {
             for (size_t i = other.m_size; i < m_size; i++) {
-                (m_arr + i)->~T();
+                destroy(m_arr + i);
             }
             for (size_t i = 0; i < other.m_size; i++) {
                 m_arr[i] = other.m_arr[i];
@@ -120,21 +349,52 @@ public:
         return *this;
     }
 
-    Vector& operator=(Vector&& other) noexcept {
+    // noexcept only if buffer can always be stolen
+    Vector& operator=(Vector&& other) noexcept(AllocTraits::propagate_on_container_move_assignment::value ||
+                                               AllocTraits::is_always_equal::value) {
         if (this == &other) return *this;
-        // Release Resources
-        reset();
-        // Move
-        m_arr = other.m_arr;
-        m_cap = other.m_cap;
-        m_size = other.m_size;
-        // Invalidate other 
-        other.m_arr = nullptr;
-        other.m_size = 0;
-        other.m_cap = 0;
+        if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+            // Release Resources
+            reset();
+            m_alloc = std::move(other.m_alloc);
+            takeBuffer(other);
+        }
+        else {
+            if (m_alloc == other.m_alloc) {
+                reset();
+                takeBuffer(other);
+                return *this;
+            }
+            // Different arenas : buffer can't change hands, move elements one by one
+            clear();
+            reserve(other.m_size);
+            for (size_t i = 0; i < other.m_size; i++) {
+                construct(m_arr + i, std::move(other.m_arr[i]));
+            }
+            m_size = other.m_size;
+            other.clear();
+        }
         return *this;
     }
     //..... Rule of 5  End ..... 
+
+    // Swapping vectors with unequal non propagating allocators is undefined, same as std containers
+    friend void swap(Vector& f, Vector& s) noexcept {
+        using std::swap;
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            swap(f.m_alloc, s.m_alloc);
+        }
+        else {
+            assert(f.m_alloc == s.m_alloc);
+        }
+        swap(f.m_arr, s.m_arr);
+        swap(f.m_cap, s.m_cap);
+        swap(f.m_size, s.m_size);
+    }
+    AllocT get_allocator() const {
+        return m_alloc;
+    }
+
     
     void resize(size_t newSize) {
         if (m_size < newSize) {
@@ -142,14 +402,14 @@ public:
                 increaseCapacity(newSize);
             }
             for(size_t i = m_size; i < newSize; i++) {
-                new (m_arr + i) T();
+                construct(m_arr + i);
             }
             m_size = newSize;
         }
         else if (m_size > newSize) {
             // reduce to m_size elements
             for(size_t i = newSize; i < m_size; i++) {
-                (m_arr + i)->~T();
+                destroy(m_arr + i);
             }
             m_size = newSize;
         }
@@ -160,14 +420,14 @@ public:
                 increaseCapacity(newSize);
             }
             for(size_t i = m_size; i < newSize; i++) {
-                new (m_arr + i) T(defaultValue);
+                construct(m_arr + i, defaultValue);
             }
             m_size = newSize;
         }
         else if (m_size > newSize) {
             // reduce to m_size elements
             for(size_t i = newSize; i < m_size; i++) {
-                (m_arr + i)->~T();
+                destroy(m_arr + i);
             }
             m_size = newSize;
         }
@@ -184,17 +444,266 @@ public:
             return;
         }
         T* newArrayPtr = reinterpret_cast<T*>(allocateRaw(m_size));
+        relocate(newArrayPtr, m_arr, m_size);
+        deallocateRaw(m_arr, m_cap);
+        m_cap = m_size;
+        m_arr = newArrayPtr;
+    }
+    void reserve(size_t capacity) {
+        if (m_cap >= capacity) return;
+        increaseCapacity(capacity);
+    }
+
+    // Grows size without constructing elements, caller must write [old size, newSize) before reading it
+    // e.g. resize_uninitialized(size() + n) and read() directly into data() + old size
+    void resize_uninitialized(size_t newSize) {
+        static_assert(std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>,
+                      "resize_uninitialized requires trivially constructible / destructible T");
+        ensureCapacity(newSize);
+        m_size = newSize;
+    }
+
+    // Appending functions start...
+    // Bulk append : one capacity check for the whole range, memcpy for contiguous trivially copyable ranges
+    template<typename InputIt>
+    void append(InputIt first, InputIt last) {
+        if constexpr (std::forward_iterator<InputIt>) {
+            size_t n = static_cast<size_t>(std::distance(first, last));
+            size_t off = aliasedOffset(first, last);
+            ensureCapacity(m_size + n);
+            if (off != m_size) {
+                // Range is part of this vector : growing may have moved it, rebase on the (possibly new) buffer
+                copyConstruct(m_arr + m_size, m_arr + off, m_arr + off + n);
+            }
+            else {
+                copyConstruct(m_arr + m_size, first, last);
+            }
+            m_size += n;
+        }
+        else {
+            // Single pass range, size unknown
+            for (; first != last; ++first) {
+                emplace_back(*first);
+            }
+        }
+    }
+    // Inserts [first, last) before index pos, returns index of first inserted element
+    template<typename ForwardIt>
+    size_t insert(size_t pos, ForwardIt first, ForwardIt last) {
+        assert(pos <= m_size);
+        size_t n = static_cast<size_t>(std::distance(first, last));
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            size_t off = aliasedOffset(first, last);
+            ensureCapacity(m_size + n);
+            // Open a hole of n elements and copy the range into it
+            if (pos != m_size) {
+                std::memmove(static_cast<void*>(m_arr + pos + n), static_cast<const void*>(m_arr + pos), (m_size - pos) * sizeof(T));
+            }
+            if (off != m_size) {
+                // Range is part of this vector : the piece before pos stayed put, the rest moved up by n
+                size_t before = off < pos ? std::min(off + n, pos) - off : 0;
+                if (before != 0) {
+                    std::memcpy(static_cast<void*>(m_arr + pos), static_cast<const void*>(m_arr + off), before * sizeof(T));
+                }
+                if (before != n) {
+                    std::memcpy(static_cast<void*>(m_arr + pos + before), static_cast<const void*>(m_arr + std::max(off, pos) + n), (n - before) * sizeof(T));
+                }
+            }
+            else {
+                copyConstruct(m_arr + pos, first, last);
+            }
+            m_size += n;
+        }
+        else {
+            // Append then rotate into place : append handles ranges aliasing the buffer and a throwing copy leaves the vector unchanged
+            size_t oldSize = m_size;
+            append(first, last);
+            std::rotate(m_arr + pos, m_arr + oldSize, m_arr + m_size);
+        }
+        return pos;
+    }
+    void push_back(const T& val) {
+        emplace_back(val);
+    }
+    void push_back(T&& val) {
+        emplace_back(std::move(val));
+    }
+    template<typename... ArgsT>
+    void emplace_back(ArgsT&&... args) {
+        if (m_size == m_cap) {
+            growAndEmplace(std::forward<ArgsT>(args)...);
+            return;
+        }
+        construct(m_arr + m_size, std::forward<ArgsT>(args)...);
+        m_size++;
+    }
+    // Appending functions end...
+
+    // Back
+    const T& back() const {
+        return m_arr[m_size - 1];
+    }
+
+    T* data() {
+        return m_arr;
+    }
+    const T* data() const {
+        return m_arr;
+    }
+
+    // at
+    T& at(size_t idx) {
+        if (idx < m_size) {
+            return m_arr[idx];
+        }
+        throw std::out_of_range{"Array Index Out of bounds"};
+    }
+    const T& at(size_t idx) const {
+        if (idx < m_size) {
+            return m_arr[idx];
+        }
+        throw std::out_of_range{"Array Index Out of bounds"};
+    }
+
+    // Operator []
+    T& operator[](size_t idx) {
+        return m_arr[idx];
+    }
+    const T& operator[](size_t idx) const {
+        return m_arr[idx];
+    }
+
+    // Clear : Retrieve capacity but destroy elements
+    void clear() {
         for (size_t i = 0; i < m_size; i++) {
-            new (newArrayPtr+i) T(std::move_if_noexcept(m_arr[i]));
+            destroy(m_arr + i);
         }
-    
-        for (size_t i = 0; i < m_size; ++i) {
+        m_size = 0;
+    }
+
+    bool empty() const {
+        return m_size == 0;
+    }
+    size_t capacity() const { return m_cap; }
+    size_t size() const { return m_size; }
+};
+
+// Vector drawing memory from a std::pmr::memory_resource, e.g. a per request arena
+template<typename T>
+using PmrVector = Vector<T, GrowthFactor2, std::pmr::polymorphic_allocator<T>>;
+
+/*
+Vector with inline storage for up to N elements, spills to the heap only when it overflows
+    - Elements are relocated with relocateElements, same as Vector
+    - Moving an inline SmallVector relocates at most N elements, moving a spilled one steals the heap buffer
+    - Heap growth uses GrowthPolicyT, same as Vector
+*/
+template<typename T, size_t N, typename GrowthPolicyT = GrowthFactor2>
+class SmallVector {
+    static_assert(N > 0, "SmallVector needs at least one inline element, use Vector otherwise");
+private:
+    T* m_arr{inlineBuffer()};
+    size_t m_cap{N};
+    size_t m_size{0};
+    alignas(T) unsigned char m_inline[N * sizeof(T)];
+
+    T* inlineBuffer() {
+        return reinterpret_cast<T*>(m_inline);
+    }
+    bool isInline() const {
+        return m_arr == reinterpret_cast<const T*>(m_inline);
+    }
+    void* allocateRaw(size_t size) {
+        // Allocate raw bytes, set alignment as well while allocating raw bytes
+        return ::operator new[](size * sizeof(T), std::align_val_t(alignof(T)));
+    }
+    void deallocate() noexcept {
+        if (!isInline()) {
+            ::operator delete[](m_arr, std::align_val_t(alignof(T)));
+        }
+        m_arr = inlineBuffer();
+        m_cap = N;
+    }
+    void increaseCapacity(size_t newCap) {
+        assert(newCap >= m_cap);
+        T* newArrPtr = reinterpret_cast<T*>(allocateRaw(newCap));
+        relocateElements(newArrPtr, m_arr, m_size);
+        deallocate();
+        m_arr = newArrPtr;
+        m_cap = newCap;
+    }
+    // Full : args may refer to an element being relocated, build the new element before growing
+    template<typename... ArgsT>
+    void growAndEmplace(ArgsT&&... args) {
+        T tmp(std::forward<ArgsT>(args)...);
+        increaseCapacity(GrowthPolicyT::grow(m_cap));
+        new (m_arr + m_size) T(std::move(tmp));
+        m_size++;
+    }
+    void destroyAll() noexcept {
+        for (size_t i = 0; i < m_size; i++) {
             (m_arr + i)->~T();
         }
-        ::operator delete[](m_arr, std::align_val_t(alignof(T)));
-        m_cap = m_size;
-        m_arr = newArrayPtr;
+        m_size = 0;
+    }
+    // Takes elements of other, other is left empty and inline
+    void moveFrom(SmallVector& other) noexcept {
+        if (other.isInline()) {
+            static_assert(IsTriviallyRelocatable<T>::value || std::is_nothrow_move_constructible_v<T>,
+                          "SmallVector move requires relocatable or nothrow movable T");
+            relocateElements(m_arr, other.m_arr, other.m_size);
+        }
+        else {
+            m_arr = other.m_arr;
+            m_cap = other.m_cap;
+            other.m_arr = other.inlineBuffer();
+            other.m_cap = N;
+        }
+        m_size = other.m_size;
+        other.m_size = 0;
+    }
+public:
+    SmallVector() = default;
+
+    //..... Rule of 5 Start .....
+    ~SmallVector() {
+        destroyAll();
+        deallocate();
+    }
+    SmallVector(const SmallVector& other) {
+        if (other.m_size > N) {
+            increaseCapacity(other.m_size);
+        }
+        for (size_t i = 0; i < other.m_size; i++) {
+            new (m_arr + i) T(other.m_arr[i]);
+            m_size++;
+        }
     }
+    SmallVector(SmallVector&& other) noexcept {
+        moveFrom(other);
+    }
+    SmallVector& operator=(const SmallVector& other) {
+        if (this == &other) return *this;
+        destroyAll();
+        if (other.m_size > m_cap) {
+            increaseCapacity(other.m_size);
+        }
+        for (size_t i = 0; i < other.m_size; i++) {
+            new (m_arr + i) T(other.m_arr[i]);
+            m_size++;
+        }
+        return *this;
+    }
+    SmallVector& operator=(SmallVector&& other) noexcept {
+        if (this == &other) return *this;
+        // Release Resources
+        destroyAll();
+        deallocate();
+        moveFrom(other);
+        return *this;
+    }
+    //..... Rule of 5  End .....
+
     void reserve(size_t capacity) {
         if (m_cap >= capacity) return;
         increaseCapacity(capacity);
@@ -202,35 +711,211 @@ public:
 
     // Appending functions start...
     void push_back(const T& val) {
+        emplace_back(val);
+    }
+    void push_back(T&& val) {
+        emplace_back(std::move(val));
+    }
+    template<typename... ArgsT>
+    void emplace_back(ArgsT&&... args) {
         if (m_size == m_cap) {
-            increaseCapacity(m_cap ? m_cap << 1 : 1);
+            growAndEmplace(std::forward<ArgsT>(args)...);
+            return;
+        }
+        new (m_arr + m_size) T(std::forward<ArgsT>(args)...);
+        m_size++;
+    }
+    // Appending functions end...
+
+    void pop_back() {
+        m_size--;
+        (m_arr + m_size)->~T();
+    }
+    const T& back() const {
+        return m_arr[m_size - 1];
+    }
+    T& operator[](size_t idx) {
+        return m_arr[idx];
+    }
+    const T& operator[](size_t idx) const {
+        return m_arr[idx];
+    }
+
+    // Clear : Retrieve capacity but destroy elements
+    void clear() {
+        destroyAll();
+    }
+
+    T* begin() { return m_arr; }
+    T* end() { return m_arr + m_size; }
+    const T* begin() const { return m_arr; }
+    const T* end() const { return m_arr + m_size; }
+
+    bool empty() const {
+        return m_size == 0;
+    }
+    bool isSmall() const {
+        return isInline();
+    }
+    size_t capacity() const { return m_cap; }
+    size_t size() const { return m_size; }
+};
+
+#ifdef __linux__
+/*
+Vector for huge columns : reserves maxSize elements of virtual address space up front
+and commits pages in COMMIT_CHUNK steps as it grows
+    - growth never copies or moves elements, so element addresses are stable
+    - peak memory is the committed size, not old + new buffer as with increaseCapacity
+    - going past maxSize throws std::length_error
+*/
+template<typename T>
+class HugeVector {
+    static_assert(alignof(T) <= 4096, "HugeVector storage is only page aligned");
+private:
+    // Commit granularity, a multiple of the 2 MB huge page size so THP can back the column
+    static constexpr size_t COMMIT_CHUNK = 2 << 20;
+
+    T* m_arr{nullptr};
+    size_t m_size{0};
+    size_t m_committedBytes{0};
+    size_t m_reservedBytes{0};
+
+    static size_t roundUp(size_t bytes, size_t to) {
+        return (bytes + to - 1) / to * to;
+    }
+    // Makes pages for at least n elements readable / writable
+    void commit(size_t n) {
+        size_t bytes = std::min(roundUp(n * sizeof(T), COMMIT_CHUNK), m_reservedBytes);
+        if (bytes <= m_committedBytes) {
+            return;
+        }
+        char* base = reinterpret_cast<char*>(m_arr);
+        if (mprotect(base + m_committedBytes, bytes - m_committedBytes, PROT_READ | PROT_WRITE) != 0) {
+            throw std::bad_alloc{};
+        }
+        m_committedBytes = bytes;
+    }
+    void grow() {
+        if ((m_size + 1) * sizeof(T) > m_reservedBytes) {
+            throw std::length_error{"HugeVector reserved size exceeded"};
+        }
+        commit(m_size + 1);
+    }
+    void release() noexcept {
+        clear();
+        if (m_arr != nullptr) {
+            munmap(m_arr, m_reservedBytes);
+        }
+        m_arr = nullptr;
+        m_committedBytes = 0;
+        m_reservedBytes = 0;
+    }
+public:
+    explicit HugeVector(size_t maxSize) {
+        m_reservedBytes = roundUp(std::max<size_t>(maxSize, 1) * sizeof(T), COMMIT_CHUNK);
+        // Address space only : no memory or swap is charged until pages are committed
+        // Over reserve by one chunk so the base can be aligned to a huge page boundary
+        size_t mappedBytes = m_reservedBytes + COMMIT_CHUNK;
+        void* ptr = mmap(nullptr, mappedBytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (ptr == MAP_FAILED) {
+            throw std::bad_alloc{};
+        }
+        char* raw = static_cast<char*>(ptr);
+        char* base = reinterpret_cast<char*>(roundUp(reinterpret_cast<uintptr_t>(raw), COMMIT_CHUNK));
+        // Give back the unaligned head and the unused tail
+        size_t head = static_cast<size_t>(base - raw);
+        if (head != 0) {
+            munmap(raw, head);
+        }
+        if (mappedBytes - head > m_reservedBytes) {
+            munmap(base + m_reservedBytes, mappedBytes - head - m_reservedBytes);
+        }
+        // Hint only, ignored if THP is disabled
+        madvise(base, m_reservedBytes, MADV_HUGEPAGE);
+        m_arr = reinterpret_cast<T*>(base);
+    }
+
+    //..... Rule of 5 Start .....
+    ~HugeVector() {
+        release();
+    }
+    HugeVector(const HugeVector&) = delete;
+    HugeVector& operator=(const HugeVector&) = delete;
+    HugeVector(HugeVector&& other) noexcept :
+        m_arr{other.m_arr}, m_size{other.m_size}, m_committedBytes{other.m_committedBytes}, m_reservedBytes{other.m_reservedBytes} {
+        other.m_arr = nullptr;
+        other.m_size = 0;
+        other.m_committedBytes = 0;
+        other.m_reservedBytes = 0;
+    }
+    HugeVector& operator=(HugeVector&& other) noexcept {
+        if (this == &other) return *this;
+        release();
+        std::swap(m_arr, other.m_arr);
+        std::swap(m_size, other.m_size);
+        std::swap(m_committedBytes, other.m_committedBytes);
+        std::swap(m_reservedBytes, other.m_reservedBytes);
+        return *this;
+    }
+    //..... Rule of 5  End .....
+
+    // Commits pages up front, elements are not constructed
+    void reserve(size_t capacity) {
+        if (capacity * sizeof(T) > m_reservedBytes) {
+            throw std::length_error{"HugeVector reserved size exceeded"};
+        }
+        commit(capacity);
+    }
+    // Returns pages past size() to the OS
+    void shrinkToFit() {
+        size_t bytes = roundUp(m_size * sizeof(T), COMMIT_CHUNK);
+        if (bytes >= m_committedBytes) {
+            return;
+        }
+        char* base = reinterpret_cast<char*>(m_arr);
+        // Non binding like std::vector::shrink_to_fit : on failure the pages simply stay committed
+        if (madvise(base + bytes, m_committedBytes - bytes, MADV_DONTNEED) != 0) {
+            return;
+        }
+        if (mprotect(base + bytes, m_committedBytes - bytes, PROT_NONE) != 0) {
+            return;
+        }
+        m_committedBytes = bytes;
+    }
+
+    // Appending functions start...
+    void push_back(const T& val) {
+        if ((m_size + 1) * sizeof(T) > m_committedBytes) {
+            grow();
         }
         new (m_arr + m_size) T(val);
         m_size++;
     }
     void push_back(T&& val) {
-        if (m_size == m_cap) {
-            increaseCapacity(m_cap ? m_cap << 1 : 1);
+        if ((m_size + 1) * sizeof(T) > m_committedBytes) {
+            grow();
         }
         new (m_arr + m_size) T(std::move(val));
         m_size++;
     }
     template<typename... ArgsT>
     void emplace_back(ArgsT&&... args) {
-        if (m_size == m_cap) {
-            increaseCapacity(m_cap ? m_cap << 1 : 1);
+        if ((m_size + 1) * sizeof(T) > m_committedBytes) {
+            grow();
         }
         new (m_arr + m_size) T(std::forward<ArgsT>(args)...);
         m_size++;
     }
     // Appending functions end...
 
-    // Back
+    void pop_back() {
+        m_size--;
+        (m_arr + m_size)->~T();
+    }
     const T& back() const {
         return m_arr[m_size - 1];
     }
-
-    // at
     T& at(size_t idx) {
         if (idx < m_size) {
             return m_arr[idx];
@@ -243,16 +928,20 @@ public:
         }
         throw std::out_of_range{"Array Index Out of bounds"};
     }
-
-    // Operator []
     T& operator[](size_t idx) {
         return m_arr[idx];
     }
     const T& operator[](size_t idx) const {
         return m_arr[idx];
     }
+    T* data() {
+        return m_arr;
+    }
+    const T* data() const {
+        return m_arr;
+    }
 
-    // Clear : Retrieve capacity but destroy elements
+    // Clear : keeps committed pages but destroys elements
     void clear() {
         for (size_t i = 0; i < m_size; i++) {
             (m_arr + i)->~T();
@@ -263,12 +952,436 @@ public:
     bool empty() const {
         return m_size == 0;
     }
-    size_t capacity() const { return m_cap; }
+    size_t capacity() const { return m_committedBytes / sizeof(T); }
+    size_t maxSize() const { return m_reservedBytes / sizeof(T); }
     size_t size() const { return m_size; }
 };
 
+// Resets the peak RSS counter (VmHWM) of this process
+void resetPeakRss() {
+    std::ofstream{"/proc/self/clear_refs"} << "5";
+}
+// Returns peak RSS in KB since last reset
+size_t peakRssKb() {
+    std::ifstream status{"/proc/self/status"};
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmHWM:", 0) == 0) {
+            return std::stoul(line.substr(6));
+        }
+    }
+    return 0;
+}
+#endif
+
+// Owns a heap buffer but never points into itself, so memcpy relocation is safe
+struct OwningBuffer {
+    int* m_data;
+    explicit OwningBuffer(int v) : m_data{new int(v)} {}
+    OwningBuffer(const OwningBuffer& other) : m_data{new int(*other.m_data)} {}
+    OwningBuffer(OwningBuffer&& other) noexcept : m_data{other.m_data} { other.m_data = nullptr; }
+    OwningBuffer& operator=(const OwningBuffer&) = delete;
+    ~OwningBuffer() { delete m_data; }
+};
+template<> struct IsTriviallyRelocatable<OwningBuffer> : std::true_type {};
+
+// Trivially copyable but opted out of memcpy relocation
+struct OpaqueLong {
+    long long m_val;
+};
+template<> struct IsTriviallyRelocatable<OpaqueLong> : std::false_type {};
+
+template<typename VectorT, typename MakeT>
+long long benchmarkPushBack(size_t n, MakeT make) {
+    auto start = std::chrono::high_resolution_clock::now();
+    {
+        VectorT v;
+        for (size_t i = 0; i < n; i++) {
+            v.push_back(make(i));
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+// Count aligned array allocations (used by Vector / SmallVector) for the benchmark
+size_t g_numAllocations = 0;
+void* operator new[](size_t size, std::align_val_t align) {
+    g_numAllocations++;
+    size_t alignment = std::max(static_cast<size_t>(align), alignof(std::max_align_t));
+    void* ptr = std::aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
+    if (ptr == nullptr) {
+        throw std::bad_alloc{};
+    }
+    return ptr;
+}
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+// Builds many short lists, returns nanoseconds taken
+template<typename VectorT>
+long long benchmarkShortLists(size_t nMessages, long long& checksum) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t m = 0; m < nMessages; m++) {
+        VectorT fields;
+        size_t nFields = 1 + (m * 7) % 8; // 1..8 fields per message
+        for (size_t i = 0; i < nFields; i++) {
+            fields.push_back(static_cast<int>(m + i));
+        }
+        for (size_t i = 0; i < nFields; i++) {
+            checksum += fields[i];
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
 int main() {
     Vector<int> x;
     x.push_back(100);
-    std::cout << x[0];
+    std::cout << x[0] << '\n';
+
+    // Relocation paths : memcpy (small), mremap (large), opt in type, non relocatable type
+    {
+        Vector<int, GrowthFactor1_5> ints;
+        for (int i = 0; i < 1'000'000; i++) {
+            ints.push_back(i);
+        }
+        for (int i = 0; i < 1'000'000; i++) {
+            assert(ints[i] == i);
+        }
+        ints.resize(10);
+        ints.shrinkToFit();
+        assert(ints.capacity() == 10 && ints[9] == 9);
+
+        Vector<OwningBuffer> buffers;
+        for (int i = 0; i < 1000; i++) {
+            buffers.emplace_back(i);
+        }
+        assert(*buffers[999].m_data == 999);
+
+        Vector<std::string> strings;
+        for (int i = 0; i < 1000; i++) {
+            strings.push_back(std::to_string(i) + " long enough to live on the heap");
+        }
+        assert(strings[999] == "999 long enough to live on the heap");
+    }
+
+    // SmallVector
+    {
+        SmallVector<std::string, 2> small;
+        small.push_back("a");
+        small.emplace_back("b");
+        assert(small.isSmall());
+        SmallVector<std::string, 2> moved{std::move(small)}; // inline move relocates
+        assert(moved.size() == 2 && moved[1] == "b" && small.empty());
+        moved.push_back("c"); // spills
+        assert(!moved.isSmall() && moved.capacity() >= 3);
+        SmallVector<std::string, 2> copy{moved};
+        assert(copy.size() == 3 && copy[2] == "c");
+        SmallVector<std::string, 2> stolen;
+        stolen = std::move(moved); // heap move steals buffer
+        assert(stolen.size() == 3 && moved.isSmall() && moved.empty());
+        copy = small;
+        assert(copy.empty());
+        stolen.pop_back();
+        assert(stolen.back() == "b");
+
+        // Pushing an own element while full : it is read before being relocated
+        std::string longWord(40, 'w');
+        SmallVector<std::string, 2> self;
+        self.push_back(longWord);
+        self.push_back("x");
+        self.push_back(self[0]); // inline to heap
+        self.push_back(self[1]); // heap to heap
+        assert(self.size() == 4 && self[2] == longWord && self[3] == "x");
+        self.emplace_back(self[2]);
+        assert(self[4] == longWord);
+        Vector<std::string> vecSelf;
+        vecSelf.push_back(longWord);
+        vecSelf.push_back(vecSelf[0]);
+        vecSelf.emplace_back(vecSelf[1]);
+        assert(vecSelf.size() == 3 && vecSelf[1] == longWord && vecSelf[2] == longWord);
+
+        size_t before = g_numAllocations;
+        SmallVector<int, 8> ints;
+        for (int i = 0; i < 8; i++) {
+            ints.push_back(i);
+        }
+        assert(g_numAllocations == before);
+    }
+
+    // Allocator propagation
+    {
+        static_assert(sizeof(Vector<int>) == 3 * sizeof(size_t)); // default allocator takes no space
+        std::pmr::monotonic_buffer_resource arena1;
+        std::pmr::monotonic_buffer_resource arena2;
+        PmrVector<std::string> v1{&arena1};
+        PmrVector<std::string> v2{&arena2};
+        v1.push_back("kept in arena one, long enough to not use sso");
+        v2.push_back("b");
+        v2 = std::move(v1); // polymorphic_allocator does not propagate : element wise move
+        assert(v2.get_allocator().resource() == &arena2);
+        assert(v2.size() == 1 && v1.empty());
+        PmrVector<std::string> v3{std::move(v2)}; // move construction always takes the allocator
+        assert(v3.get_allocator().resource() == &arena2);
+        PmrVector<std::string> v4{v3}; // copy construction goes to the default resource
+        assert(v4.get_allocator().resource() == std::pmr::get_default_resource());
+        PmrVector<std::string> v5{&arena2};
+        swap(v3, v5);
+        assert(v5.size() == 1 && v3.empty());
+
+        // Allocator aware elements get the vector's resource, also through growth, copies and sized Ctors
+        std::string longText(64, 'x');
+        PmrVector<std::pmr::string> strings{&arena1};
+        for (int i = 0; i < 10; i++) {
+            strings.push_back(std::pmr::string{longText, std::pmr::get_default_resource()});
+        }
+        strings.emplace_back(longText);
+        strings.resize(20);
+        for (size_t i = 0; i < strings.size(); i++) {
+            assert(strings[i].get_allocator().resource() == &arena1);
+        }
+        PmrVector<std::pmr::string> sized(4, &arena2);
+        PmrVector<std::pmr::string> filled(4, std::pmr::string{longText}, &arena2);
+        assert(sized.size() == 4 && filled.size() == 4 && filled[3] == longText.c_str());
+        assert(sized.get_allocator().resource() == &arena2 && sized[0].get_allocator().resource() == &arena2);
+        assert(filled[0].get_allocator().resource() == &arena2);
+        PmrVector<std::pmr::string> copied{filled}; // default resource, elements follow the vector
+        assert(copied[0].get_allocator().resource() == std::pmr::get_default_resource());
+    }
+
+    // Benchmark : default heap vs per request arena
+    {
+        size_t nRequests = 100'000;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t r = 0; r < nRequests; r++) {
+            Vector<int> v;
+            for (int i = 0; i < 100; i++) {
+                v.push_back(i);
+            }
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        std::cout << "Vector default heap took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+
+        start = std::chrono::high_resolution_clock::now();
+        std::array<std::byte, 1 << 14> buffer;
+        for (size_t r = 0; r < nRequests; r++) {
+            std::pmr::monotonic_buffer_resource arena{buffer.data(), buffer.size()};
+            PmrVector<int> v{&arena};
+            for (int i = 0; i < 100; i++) {
+                v.push_back(i);
+            }
+        }
+        end = std::chrono::high_resolution_clock::now();
+        std::cout << "Vector arena took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+    }
+
+    // Bulk append / insert / resize_uninitialized
+    {
+        Vector<int> v;
+        int src[] = {1, 2, 3, 4};
+        v.append(std::begin(src), std::end(src));
+        v.insert(1, std::begin(src), std::begin(src) + 2); // 1 1 2 2 3 4
+        v.insert(v.size(), std::begin(src), std::begin(src) + 1); // 1 1 2 2 3 4 1
+        assert(v.size() == 7 && v[1] == 1 && v[2] == 2 && v[3] == 2 && v[6] == 1);
+        std::list<int> notContiguous{7, 8};
+        v.insert(0, notContiguous.begin(), notContiguous.end());
+        assert(v[0] == 7 && v[1] == 8 && v[2] == 1);
+        std::istringstream in{"5 6"};
+        v.append(std::istream_iterator<int>{in}, std::istream_iterator<int>{});
+        assert(v.size() == 11 && v[10] == 6);
+
+        size_t oldSize = v.size();
+        v.resize_uninitialized(oldSize + 2);
+        std::memcpy(v.data() + oldSize, src, 2 * sizeof(int)); // e.g. read() into the tail
+        assert(v.size() == 13 && v[12] == 2);
+
+        Vector<std::string> strings;
+        std::string words[] = {"a", "d"};
+        std::string middle[] = {"b", "c"};
+        strings.append(std::begin(words), std::end(words));
+        strings.insert(1, std::begin(middle), std::end(middle));
+        assert(strings.size() == 4 && strings[0] == "a" && strings[1] == "b" && strings[2] == "c" && strings[3] == "d");
+
+        // Ranges pointing into the vector itself
+        Vector<int> self;
+        self.append(std::begin(src), std::end(src));
+        self.shrinkToFit();
+        self.insert(1, self.data(), self.data() + 2); // 1 1 2 2 3 4
+        assert(self.size() == 6 && self[0] == 1 && self[1] == 1 && self[2] == 2 && self[3] == 2 && self[5] == 4);
+        self.insert(2, self.data() + 1, self.data() + 4); // straddles pos : 1 1 1 2 2 2 2 3 4
+        assert(self.size() == 9 && self[2] == 1 && self[3] == 2 && self[4] == 2 && self[6] == 2 && self[8] == 4);
+        strings.shrinkToFit();
+        strings.append(strings.data(), strings.data() + strings.size());
+        assert(strings.size() == 8 && strings[4] == "a" && strings[7] == "d");
+        strings.insert(0, strings.data() + 6, strings.data() + 8);
+        assert(strings.size() == 10 && strings[0] == "c" && strings[1] == "d" && strings[2] == "a");
+
+        // A throwing copy leaves the vector unchanged
+        struct ThrowOnCopy {
+            int val;
+            ThrowOnCopy(int v) : val{v} {}
+            ThrowOnCopy(const ThrowOnCopy& other) : val{other.val} {
+                if (val < 0) {
+                    throw std::runtime_error("copy");
+                }
+            }
+            ThrowOnCopy& operator=(const ThrowOnCopy&) = default;
+        };
+        Vector<ThrowOnCopy> guarded;
+        guarded.emplace_back(1);
+        guarded.emplace_back(2);
+        ThrowOnCopy bad[] = {3, -1};
+        bool threw = false;
+        try {
+            guarded.insert(0, std::begin(bad), std::end(bad));
+        }
+        catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw && guarded.size() == 2 && guarded[0].val == 1 && guarded[1].val == 2);
+    }
+
+    // Benchmark : appending 64 KB decoded buffers
+    {
+        std::vector<char> decoded(1 << 16, 'x');
+        size_t nBuffers = 10'000;
+        auto start = std::chrono::high_resolution_clock::now();
+        {
+            Vector<char> out;
+            for (size_t b = 0; b < nBuffers; b++) {
+                for (char c : decoded) {
+                    out.push_back(c);
+                }
+            }
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        std::cout << "push_back per byte took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+
+        start = std::chrono::high_resolution_clock::now();
+        {
+            Vector<char> out;
+            for (size_t b = 0; b < nBuffers; b++) {
+                out.append(decoded.begin(), decoded.end());
+            }
+        }
+        end = std::chrono::high_resolution_clock::now();
+        std::cout << "append took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+
+        start = std::chrono::high_resolution_clock::now();
+        {
+            Vector<char> out;
+            for (size_t b = 0; b < nBuffers; b++) {
+                size_t oldSize = out.size();
+                out.resize(oldSize + decoded.size()); // zero fill, then overwritten
+                std::memcpy(out.data() + oldSize, decoded.data(), decoded.size());
+            }
+        }
+        end = std::chrono::high_resolution_clock::now();
+        std::cout << "resize + read took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+
+        start = std::chrono::high_resolution_clock::now();
+        {
+            Vector<char> out;
+            for (size_t b = 0; b < nBuffers; b++) {
+                size_t oldSize = out.size();
+                out.resize_uninitialized(oldSize + decoded.size());
+                std::memcpy(out.data() + oldSize, decoded.data(), decoded.size());
+            }
+        }
+        end = std::chrono::high_resolution_clock::now();
+        std::cout << "resize_uninitialized + read took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds!\n";
+    }
+
+#ifdef __linux__
+    // HugeVector
+    {
+        HugeVector<std::string> strings{1 << 20};
+        strings.push_back("first, long enough to live on the heap");
+        const std::string* first = &strings[0];
+        for (int i = 0; i < 100'000; i++) {
+            strings.emplace_back(std::to_string(i));
+        }
+        assert(first == &strings[0]); // growth never moves elements
+        assert(reinterpret_cast<uintptr_t>(first) % (2 << 20) == 0); // huge page aligned base
+        assert(strings.at(100'000) == "99999");
+        strings.pop_back();
+        assert(strings.back() == "99998");
+
+        HugeVector<int> small{10};
+        assert(small.maxSize() >= 10);
+        for (size_t i = 0; i < small.maxSize(); i++) {
+            small.push_back(static_cast<int>(i));
+        }
+        bool thrown = false;
+        try {
+            small.push_back(0);
+        }
+        catch (const std::length_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+        small.clear();
+        small.shrinkToFit();
+        assert(small.capacity() == 0);
+    }
+
+    // Benchmark : growth time and peak RSS for a large column
+    {
+        size_t n = 128'000'000;
+        resetPeakRss();
+        auto start = std::chrono::high_resolution_clock::now();
+        {
+            HugeVector<long long> column{size_t(1) << 36}; // 512 GB of address space
+            for (size_t i = 0; i < n; i++) {
+                column.push_back(static_cast<long long>(i));
+            }
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        std::cout << "HugeVector growth took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds! peak RSS KB: " << peakRssKb() << '\n';
+
+        resetPeakRss();
+        start = std::chrono::high_resolution_clock::now();
+        {
+            // Opt out of relocation so Vector takes the move + destroy increaseCapacity path
+            Vector<OpaqueLong> column;
+            for (size_t i = 0; i < n; i++) {
+                column.push_back(OpaqueLong{static_cast<long long>(i)});
+            }
+        }
+        end = std::chrono::high_resolution_clock::now();
+        std::cout << "Vector increaseCapacity growth took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " nanoseconds! peak RSS KB: " << peakRssKb() << '\n';
+    }
+#endif
+
+    // Benchmark : short lists
+    {
+        size_t nMessages = 10'000'000;
+        long long checksum1 = 0;
+        long long checksum2 = 0;
+        size_t before = g_numAllocations;
+        long long ns = benchmarkShortLists<Vector<int>>(nMessages, checksum1);
+        std::cout << "Vector short lists took " << ns << " nanoseconds! allocations: " << g_numAllocations - before << '\n';
+        before = g_numAllocations;
+        ns = benchmarkShortLists<SmallVector<int, 8>>(nMessages, checksum2);
+        std::cout << "SmallVector short lists took " << ns << " nanoseconds! allocations: " << g_numAllocations - before << '\n';
+        assert(checksum1 == checksum2);
+    }
+
+    // Benchmark
+    {
+        size_t nInts = 100'000'000;
+        auto makeInt = [](size_t i) { return static_cast<int>(i); };
+        std::cout << "Vector<int> 2x push_back took " << benchmarkPushBack<Vector<int, GrowthFactor2>>(nInts, makeInt) << " nanoseconds!\n";
+        std::cout << "Vector<int> 1.5x push_back took " << benchmarkPushBack<Vector<int, GrowthFactor1_5>>(nInts, makeInt) << " nanoseconds!\n";
+        std::cout << "std::vector<int> push_back took " << benchmarkPushBack<std::vector<int>>(nInts, makeInt) << " nanoseconds!\n";
+
+        size_t nStrings = 10'000'000;
+        auto makeString = [](size_t i) { return std::string(20, static_cast<char>('a' + i % 26)); };
+        std::cout << "Vector<string> 2x push_back took " << benchmarkPushBack<Vector<std::string, GrowthFactor2>>(nStrings, makeString) << " nanoseconds!\n";
+        std::cout << "Vector<string> 1.5x push_back took " << benchmarkPushBack<Vector<std::string, GrowthFactor1_5>>(nStrings, makeString) << " nanoseconds!\n";
+        std::cout << "std::vector<string> push_back took " << benchmarkPushBack<std::vector<std::string>>(nStrings, makeString) << " nanoseconds!\n";
+    }
 }